@@ -0,0 +1,123 @@
+#include "assets.h"
+#include <iostream>
+using namespace std;
+using namespace sf;
+int addImage(AssetLoader& loader, const string& name, const void* data, size_t size)
+{
+    AssetJob job = {name, data, size, ASSET_IMAGE, static_cast<int>(loader.images.size()), false, 0.0f};
+    loader.jobs.push_back(job);
+    loader.images.push_back(Image());
+    return job.index;
+}
+int addSound(AssetLoader& loader, const string& name, const void* data, size_t size)
+{
+    AssetJob job = {name, data, size, ASSET_SOUND, static_cast<int>(loader.sounds.size()), false, 0.0f};
+    loader.jobs.push_back(job);
+    PcmAudio sound;
+    sound.fromCache = false;
+    sound.cache.data = nullptr;
+    loader.sounds.push_back(sound);
+    return job.index;
+}
+bool decodeSound(const AssetJob& job, PcmAudio& sound)
+{
+    InputSoundFile file;
+    if (!file.openFromMemory(job.data, job.size))
+    {
+        return false;
+    }
+    sound.decoded.resize(static_cast<size_t>(file.getSampleCount()));
+    sound.samples = sound.decoded.data();
+    sound.sampleCount = sound.decoded.size();
+    sound.channelCount = file.getChannelCount();
+    sound.sampleRate = file.getSampleRate();
+    return file.read(sound.decoded.data(), sound.decoded.size()) == sound.decoded.size();
+}
+// From the cache when it has this exact file, otherwise decode and fill the cache for next time
+bool loadSound(const AssetLoader& loader, const AssetJob& job, PcmAudio& sound)
+{
+    if (loader.pcmCacheFolder.empty())
+    {
+        return decodeSound(job, sound);
+    }
+    uint64_t key = pcmCacheKey(job.data, job.size);
+    string path = pcmCachePath(loader.pcmCacheFolder, key);
+    if (openPcmCache(sound, path, key))
+    {
+        return true;
+    }
+    if (!decodeSound(job, sound))
+    {
+        return false;
+    }
+    writePcmCache(path, key, sound);
+    return true;
+}
+// Each worker takes the next job until there are none left
+void loadAssets(AssetLoader* loader)
+{
+    int total = static_cast<int>(loader->jobs.size());
+    for (int i = loader->nextJob++; i < total; i = loader->nextJob++)
+    {
+        AssetJob& job = loader->jobs[i];
+        Clock clock;
+        if (job.kind == ASSET_IMAGE)
+        {
+            job.loaded = loader->images[job.index].loadFromMemory(job.data, job.size);
+        }
+        else
+        {
+            job.loaded = loadSound(*loader, job, loader->sounds[job.index]);
+        }
+        job.seconds = clock.getElapsedTime().asSeconds();
+        loader->jobsDone++;
+    }
+}
+void startAssetLoader(AssetLoader& loader, int threads)
+{
+    loader.nextJob = 0;
+    loader.jobsDone = 0;
+    // SFML registers its sound decoders the first time a sound file is opened, which is not thread safe,
+    // so open one here before the workers race to do it
+    for (size_t i = 0; i < loader.jobs.size(); i++)
+    {
+        if (loader.jobs[i].kind == ASSET_SOUND)
+        {
+            InputSoundFile warmUp;
+            warmUp.openFromMemory(loader.jobs[i].data, loader.jobs[i].size);
+            break;
+        }
+    }
+    if (threads < 1)
+        threads = 1;
+    for (int i = 0; i < threads; i++)
+    {
+        loader.threads.push_back(thread(loadAssets, &loader));
+    }
+}
+int assetsDone(const AssetLoader& loader)
+{
+    return loader.jobsDone;
+}
+bool finishAssetLoader(AssetLoader& loader)
+{
+    for (size_t i = 0; i < loader.threads.size(); i++)
+    {
+        loader.threads[i].join();
+    }
+    loader.threads.clear();
+    bool allLoaded = true;
+    for (size_t i = 0; i < loader.jobs.size(); i++)
+    {
+        if (!loader.jobs[i].loaded)
+        {
+            cerr << "Failed to load " << loader.jobs[i].name << endl;
+            allLoaded = false;
+        }
+    }
+    return allLoaded;
+}
+bool finishSound(const PcmAudio& sound, SoundBuffer& buffer)
+{
+    return buffer.loadFromSamples(sound.samples, sound.sampleCount, sound.channelCount, sound.sampleRate);
+}
@@ -0,0 +1,41 @@
+// Startup asset loading
+// Decoding the images and sounds (several are MP3) is most of the startup time, so it runs on worker threads
+// while the main thread keeps the window responsive with a progress screen. Only the last step, handing the
+// decoded pixels and samples to the GPU and the audio device, happens on the main thread.
+#pragma once
+#include <SFML/Audio.hpp>
+#include <SFML/Graphics.hpp>
+#include <atomic>
+#include <string>
+#include <thread>
+#include <vector>
+#include "pcmcache.h"
+const int ASSET_IMAGE = 0;
+const int ASSET_SOUND = 1;
+struct AssetJob
+{
+    std::string name;
+    const void* data; // encoded file, inside the asset pack
+    size_t size;
+    int kind;      // ASSET_IMAGE or ASSET_SOUND
+    int index;     // into images or sounds
+    bool loaded;
+    float seconds; // decode time, for --startup-report
+};
+struct AssetLoader
+{
+    std::vector<AssetJob> jobs;
+    std::vector<sf::Image> images;
+    std::vector<PcmAudio> sounds;
+    std::string pcmCacheFolder; // where decoded sounds are cached (empty = decode every time)
+    std::vector<std::thread> threads;
+    std::atomic<int> nextJob;
+    std::atomic<int> jobsDone;
+};
+// Queue everything first (returns the index into images / sounds), then start the workers
+int addImage(AssetLoader& loader, const std::string& name, const void* data, size_t size);
+int addSound(AssetLoader& loader, const std::string& name, const void* data, size_t size);
+void startAssetLoader(AssetLoader& loader, int threads);
+int assetsDone(const AssetLoader& loader);
+bool finishAssetLoader(AssetLoader& loader); // waits for the workers, false if anything failed to decode
+bool finishSound(const PcmAudio& sound, sf::SoundBuffer& buffer);
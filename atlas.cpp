@@ -0,0 +1,82 @@
+#include "atlas.h"
+#include <algorithm>
+#include <filesystem>
+#include <iostream>
+using namespace std;
+using namespace sf;
+unsigned packRects(const vector<Vector2u>& sizes, unsigned width, vector<IntRect>& rects)
+{
+    // Tallest images first so each shelf wastes as little height as possible
+    vector<int> order(sizes.size());
+    for (size_t i = 0; i < order.size(); i++)
+    {
+        order[i] = static_cast<int>(i);
+    }
+    stable_sort(order.begin(), order.end(), [&sizes](int a, int b) { return sizes[a].y > sizes[b].y; });
+    rects.assign(sizes.size(), IntRect());
+    unsigned shelfX = 0, shelfY = 0, shelfHeight = 0;
+    for (size_t i = 0; i < order.size(); i++)
+    {
+        Vector2u size = sizes[order[i]];
+        unsigned paddedWidth = size.x + ATLAS_PADDING * 2;
+        unsigned paddedHeight = size.y + ATLAS_PADDING * 2;
+        if (paddedWidth > width)
+        {
+            return 0;
+        }
+        if (shelfX + paddedWidth > width) // start a new shelf below
+        {
+            shelfY += shelfHeight;
+            shelfX = 0;
+            shelfHeight = 0;
+        }
+        rects[order[i]] = IntRect(shelfX + ATLAS_PADDING, shelfY + ATLAS_PADDING, size.x, size.y);
+        shelfX += paddedWidth;
+        shelfHeight = max(shelfHeight, paddedHeight);
+    }
+    return shelfY + shelfHeight;
+}
+bool buildAtlas(TextureAtlas& atlas, const vector<string>& paths, const vector<Image>& images)
+{
+    vector<Vector2u> sizes(paths.size());
+    atlas.names.clear();
+    for (size_t i = 0; i < paths.size(); i++)
+    {
+        sizes[i] = images[i].getSize();
+        atlas.names.push_back(filesystem::path(paths[i]).filename().string());
+    }
+    // Smallest power of two width whose packing is not taller than it is wide
+    unsigned maxSize = Texture::getMaximumSize();
+    unsigned width = 64;
+    unsigned height = packRects(sizes, width, atlas.rects);
+    while (height == 0 || height > width)
+    {
+        width *= 2;
+        if (width > maxSize)
+        {
+            cerr << "Images do not fit in one " << maxSize << "px texture" << endl;
+            return false;
+        }
+        height = packRects(sizes, width, atlas.rects);
+    }
+    Image atlasImage;
+    atlasImage.create(width, height, Color::Transparent);
+    for (size_t i = 0; i < images.size(); i++)
+    {
+        atlasImage.copy(images[i], atlas.rects[i].left, atlas.rects[i].top);
+    }
+    return atlas.texture.loadFromImage(atlasImage);
+}
+bool findAtlasRect(const TextureAtlas& atlas, const char name[], IntRect& rect)
+{
+    for (size_t i = 0; i < atlas.names.size(); i++)
+    {
+        if (atlas.names[i] == name)
+        {
+            rect = atlas.rects[i];
+            return true;
+        }
+    }
+    cerr << "Image " << name << " is missing from the texture atlas" << endl;
+    return false;
+}
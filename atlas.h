@@ -0,0 +1,20 @@
+// Texture atlas: every image under assets/images packed into one texture at startup
+// Sprites then pick their image with a texture rectangle, so the whole board can be drawn with a single
+// texture binding.
+#pragma once
+#include <SFML/Graphics.hpp>
+#include <string>
+#include <vector>
+const int ATLAS_PADDING = 2; // empty pixels around each image so neighbours never bleed into each other
+struct TextureAtlas
+{
+    sf::Texture texture;
+    std::vector<std::string> names; // image file names, e.g. "player.png"
+    std::vector<sf::IntRect> rects; // where each image sits in the texture
+};
+// Shelf packing: places the sizes into rows of the given width, returns the height used (0 if something is too wide)
+unsigned packRects(const std::vector<sf::Vector2u>& sizes, unsigned width, std::vector<sf::IntRect>& rects);
+// Packs already decoded images (one per path, in name order so the layout is the same on every run) and
+// uploads the texture, so must run on the window's thread
+bool buildAtlas(TextureAtlas& atlas, const std::vector<std::string>& paths, const std::vector<sf::Image>& images);
+bool findAtlasRect(const TextureAtlas& atlas, const char name[], sf::IntRect& rect);
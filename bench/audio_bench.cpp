@@ -0,0 +1,90 @@
+// Steady-state audio cost: plays the background music for a while from the MP3 (sf::Music) and then from
+// the PCM cache (PcmStream) and reports the CPU the process used per second of music. The main thread just
+// sleeps, so that is the audio threads: decoding and streaming, plus the mixing both modes share.
+// Usage: audio_bench [pack path] [seconds per mode]
+#include "assets.h"
+#include <cstdlib>
+#include <iostream>
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <sys/resource.h>
+#endif
+using namespace std;
+// User + system CPU time of the whole process so far
+double processCpuSeconds()
+{
+#ifdef _WIN32
+    FILETIME created, exited, kernel, user;
+    GetProcessTimes(GetCurrentProcess(), &created, &exited, &kernel, &user);
+    ULARGE_INTEGER k, u;
+    k.LowPart = kernel.dwLowDateTime;
+    k.HighPart = kernel.dwHighDateTime;
+    u.LowPart = user.dwLowDateTime;
+    u.HighPart = user.dwHighDateTime;
+    return (k.QuadPart + u.QuadPart) / 1e7;
+#else
+    rusage usage;
+    getrusage(RUSAGE_SELF, &usage);
+    return usage.ru_utime.tv_sec + usage.ru_stime.tv_sec + (usage.ru_utime.tv_usec + usage.ru_stime.tv_usec) / 1e6;
+#endif
+}
+// CPU ms per second of music, measured after the stream has settled for a second
+double timeStream(sf::SoundStream& music, double seconds)
+{
+    music.setLoop(true);
+    music.setVolume(30); // as in the game
+    music.play();
+    sf::sleep(sf::seconds(1.0f));
+    double cpuStart = processCpuSeconds();
+    sf::Clock clock;
+    sf::sleep(sf::seconds(static_cast<float>(seconds)));
+    double cpu = processCpuSeconds() - cpuStart;
+    double elapsed = clock.getElapsedTime().asSeconds();
+    music.stop();
+    return cpu * 1000.0 / elapsed;
+}
+int main(int argc, char* argv[])
+{
+    string packPath = argc > 1 ? argv[1] : "assets.pack";
+    double seconds = argc > 2 ? atof(argv[2]) : 30.0;
+    if (seconds <= 0.0)
+    {
+        cerr << "Usage: audio_bench [pack path] [seconds per mode]" << endl;
+        return 1;
+    }
+    AssetPack pack;
+    const void* data;
+    size_t size;
+    if (!openPack(pack, packPath.c_str()) || !findPackFile(pack, "sounds/bg-music.mp3", data, size))
+    {
+        cerr << "No background music in " << packPath << endl;
+        return 1;
+    }
+    sf::Music mp3Music;
+    if (!mp3Music.openFromMemory(data, size))
+    {
+        cerr << "Failed to open the background music" << endl;
+        return 1;
+    }
+    // Filled from the cache like the game does (decoded and cached first if it is not there yet)
+    AssetLoader loader;
+    loader.pcmCacheFolder = pcmCacheFolder(packPath);
+    int music = addSound(loader, "sounds/bg-music.mp3", data, size);
+    startAssetLoader(loader, 1);
+    if (!finishAssetLoader(loader))
+    {
+        cerr << "Failed to decode the background music" << endl;
+        return 1;
+    }
+    PcmStream cachedMusic;
+    cachedMusic.open(loader.sounds[music]);
+    cout << "background music, " << seconds << " s per mode, CPU ms per second of music:" << endl;
+    double mp3Ms = timeStream(mp3Music, seconds);
+    cout << "  mp3 (sf::Music): " << mp3Ms << endl;
+    double cachedMs = timeStream(cachedMusic, seconds);
+    cout << "  pcm cache (PcmStream" << (loader.sounds[music].fromCache ? "" : ", decoded this run") << "): "
+         << cachedMs << endl;
+    closePack(pack);
+    return 0;
+}
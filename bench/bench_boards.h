@@ -0,0 +1,32 @@
+// Random boards shared by the grid benchmarks (sweep_bench, bitboard_bench)
+#pragma once
+#include "simulation.h"
+#include <cstdlib>
+const int DENSITY_COUNT = 3;
+const float densities[DENSITY_COUNT] = {0.05f, 0.25f, 0.75f}; // share of the cells taken
+const int LARGE_BOARD_CELLS = 100000;
+inline volatile long long benchSink; // keeps the timed loops from being optimised away
+// Random boards cycled through while timing: boardCount of them, or largeBoardCount past LARGE_BOARD_CELLS
+// to keep memory sane on stress-test boards
+inline int benchBoardCount(int rows, int cols, int boardCount, int largeBoardCount)
+{
+    return (long long)rows * cols > LARGE_BOARD_CELLS ? largeBoardCount : boardCount;
+}
+// Random board with roughly `density` of the cells taken by meteors, bullets, enemies, bosses and boss bullets
+// (rand(), so srand first for the same boards every run)
+inline void randomBoard(GameState& game, float density)
+{
+    clearGrid(game);
+    for (int r = 0; r < game.rows - 1; r++)
+    {
+        for (int c = 0; c < game.cols; c++)
+        {
+            if (rand() < density * RAND_MAX)
+            {
+                addEntity(game, 2 + rand() % 5, r, c);
+            }
+        }
+    }
+    game.spaceshipCol = game.cols / 2;
+    game.grid[game.rows - 1][game.spaceshipCol] = 1;
+}
@@ -0,0 +1,166 @@
+// Bitboard vs grid benchmark: times each movement pass on random boards in both representations
+// Usage: bitboard_bench [passes per measurement] [rows] [cols]
+#include "bench_boards.h"
+#include "bitboard.h"
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <vector>
+using namespace std;
+const int BOARD_COUNT = 64;      // random boards cycled through while timing
+const int LARGE_BOARD_COUNT = 4; // fewer of them past LARGE_BOARD_CELLS
+const int PASS_COUNT = 5;
+const char passNames[PASS_COUNT][16] = {"meteors", "enemies", "bosses", "boss bullets", "bullets"};
+// Run one grid pass with its timer due and no level ups getting in the way
+void runGridPass(GameState& game, int pass)
+{
+    game.events.clear();
+    game.collisions.clear();
+    game.isInvincible = false;
+    game.hasShield = false;
+    game.killCount = -1000000000;
+    game.bossMoveCounter = 100; // bosses always fire
+    for (int i = 0; i < TIMER_COUNT; i++)
+    {
+        game.timers[i] = 1.0f;
+    }
+    if (pass == 0) moveMeteors(game);
+    else if (pass == 1) moveEnemies(game);
+    else if (pass == 2) moveBosses(game);
+    else if (pass == 3) moveBossBullets(game);
+    else moveBullets(game);
+}
+void runBitPass(BitBoard& board, BitCollisions& hits, int pass)
+{
+    clearCollisions(board, hits);
+    if (pass == 0) bitMoveMeteors(board, hits);
+    else if (pass == 1) bitMoveEnemies(board, hits);
+    else if (pass == 2) bitMoveBosses(board, hits, true);
+    else if (pass == 3) bitMoveBossBullets(board, hits);
+    else bitMoveBullets(board, hits);
+}
+double secondsSince(chrono::steady_clock::time_point start)
+{
+    return chrono::duration<double>(chrono::steady_clock::now() - start).count();
+}
+// Seconds spent in `iterations` grid passes. Boards are reset a batch at a time outside the timed part,
+// so only the passes themselves are measured.
+double timeGridPasses(vector<GameState>& batch, const vector<BoardGrid>& grids, int pass, long long iterations)
+{
+    long long checksum = 0;
+    double seconds = 0.0;
+    int batchSize = static_cast<int>(batch.size());
+    for (long long done = 0; done < iterations; done += batchSize)
+    {
+        for (int b = 0; b < batchSize; b++)
+        {
+            batch[b].grid = grids[b];
+            rebuildPools(batch[b]);
+        }
+        auto start = chrono::steady_clock::now();
+        for (int b = 0; b < batchSize; b++)
+        {
+            runGridPass(batch[b], pass);
+        }
+        seconds += secondsSince(start);
+        checksum += batch[done % batchSize].bands[0].pools[POOL_METEOR].row.size();
+    }
+    benchSink = checksum;
+    return seconds;
+}
+double timeBitPasses(vector<BitBoard>& batch, const vector<BitBoard>& boards, BitCollisions& hits, int pass, long long iterations)
+{
+    long long checksum = 0;
+    double seconds = 0.0;
+    int batchSize = static_cast<int>(batch.size());
+    for (long long done = 0; done < iterations; done += batchSize)
+    {
+        for (int b = 0; b < batchSize; b++)
+        {
+            batch[b] = boards[b];
+        }
+        auto start = chrono::steady_clock::now();
+        for (int b = 0; b < batchSize; b++)
+        {
+            runBitPass(batch[b], hits, pass);
+            checksum += hits.playerHits;
+        }
+        seconds += secondsSince(start);
+    }
+    benchSink = checksum;
+    return seconds;
+}
+int main(int argc, char* argv[])
+{
+    long long iterations = 200000;
+    if (argc > 1)
+    {
+        iterations = atoll(argv[1]);
+    }
+    long long rowsArg = DEFAULT_ROWS;
+    long long colsArg = DEFAULT_COLS;
+    if (argc > 3)
+    {
+        rowsArg = atoll(argv[2]);
+        colsArg = atoll(argv[3]);
+    }
+    if (!validBoardSize(rowsArg, colsArg))
+    {
+        cerr << "board must be at least " << MIN_ROWS << "x1 and at most " << MAX_BOARD_CELLS << " cells" << endl;
+        return 1;
+    }
+    int rows = static_cast<int>(rowsArg);
+    int cols = static_cast<int>(colsArg);
+    int boardCount = benchBoardCount(rows, cols, BOARD_COUNT, LARGE_BOARD_COUNT);
+    srand(1);
+    GameState game;
+    setupBoard(game, rows, cols);
+    newGame(game, 3, 0, MAX_LEVEL);
+    vector<BoardGrid> grids(boardCount);
+    vector<BitBoard> boards(boardCount);
+    vector<GameState> gridBatch(boardCount, game);
+    vector<BitBoard> bitBatch(boardCount);
+    BitCollisions hits;
+    gridToBitBoard(game, boards[0]);
+    cout << "board " << rows << "x" << cols << ", grid " << rows * cols * sizeof(int) << " bytes, bitboard "
+         << BIT_TYPES * boards[0].masks[0].size() * sizeof(uint64_t) << " bytes" << endl;
+    for (int d = 0; d < DENSITY_COUNT; d++)
+    {
+        for (int b = 0; b < boardCount; b++)
+        {
+            randomBoard(game, densities[d]);
+            grids[b] = game.grid;
+            gridToBitBoard(game, boards[b]);
+        }
+        cout << endl << "density " << densities[d] * 100 << "%" << endl;
+        for (int pass = 0; pass < PASS_COUNT; pass++)
+        {
+            // Both versions must leave the same board behind
+            for (int b = 0; b < boardCount; b++)
+            {
+                BitBoard board = boards[b];
+                game.grid = grids[b];
+                rebuildPools(game);
+                runGridPass(game, pass);
+                runBitPass(board, hits, pass);
+                BitBoard expected;
+                gridToBitBoard(game, expected);
+                bool same = true;
+                for (int t = 0; t < BIT_TYPES; t++)
+                {
+                    same = same && expected.masks[t] == board.masks[t];
+                }
+                if (!same)
+                {
+                    cerr << "bitboard " << passNames[pass] << " pass differs from the grid on board " << b << endl;
+                    return 1;
+                }
+            }
+            double gridNs = timeGridPasses(gridBatch, grids, pass, iterations) * 1e9 / iterations;
+            double bitNs = timeBitPasses(bitBatch, boards, hits, pass, iterations) * 1e9 / iterations;
+            cout << "  " << passNames[pass] << ": grid " << gridNs << " ns/pass, bitboard " << bitNs
+                 << " ns/pass, speedup " << gridNs / bitNs << "x" << endl;
+        }
+    }
+    return 0;
+}
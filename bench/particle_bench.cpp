@@ -0,0 +1,110 @@
+// Particle update benchmark: times updateParticles (SSE, moving and dropping the dead in one pass) against
+// updateParticlesScalar with up to tens of thousands of live particles, topped back up after every update
+// like a busy screen of explosions
+// Usage: particle_bench [frames] [particle counts ...]
+#include "particles.h"
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <iostream>
+#include <vector>
+using namespace std;
+const float FRAME_DT = 1.0f / 60.0f;
+volatile float benchSink; // keeps the updates from being optimised away
+// Explosions until `count` particles are live
+void fillParticles(ParticleSystem& particles, size_t count)
+{
+    while (particles.count < count)
+    {
+        int burst = static_cast<int>(min<size_t>(PARTICLES_PER_EXPLOSION, count - particles.count));
+        spawnExplosion(particles, 400.0f, 300.0f, burst);
+    }
+}
+// The live particles, sorted: the two updates pack the survivors in different orders
+vector<array<float, 5>> sortedParticles(const ParticleSystem& particles)
+{
+    vector<array<float, 5>> sorted(particles.count);
+    for (size_t i = 0; i < particles.count; i++)
+    {
+        sorted[i] = {particles.life[i], particles.x[i], particles.y[i], particles.vx[i], particles.vy[i]};
+    }
+    sort(sorted.begin(), sorted.end());
+    return sorted;
+}
+// Nanoseconds per live particle per update, over `frames` updates (refilling is not timed)
+double timeUpdates(ParticleSystem& particles, size_t count, int frames, bool simd)
+{
+    double seconds = 0.0;
+    long long updated = 0;
+    for (int f = 0; f < frames; f++)
+    {
+        fillParticles(particles, count);
+        updated += particles.count;
+        auto start = chrono::steady_clock::now();
+        if (simd)
+        {
+            updateParticles(particles, FRAME_DT);
+        }
+        else
+        {
+            updateParticlesScalar(particles, FRAME_DT);
+        }
+        seconds += chrono::duration<double>(chrono::steady_clock::now() - start).count();
+    }
+    benchSink = particles.count > 0 ? particles.x[0] : 0.0f;
+    return seconds * 1e9 / updated;
+}
+int main(int argc, char* argv[])
+{
+    int frames = 2000;
+    if (argc > 1)
+    {
+        frames = atoi(argv[1]);
+    }
+    vector<size_t> counts;
+    for (int i = 2; i < argc; i++)
+    {
+        counts.push_back(static_cast<size_t>(atol(argv[i])));
+    }
+    if (counts.empty())
+    {
+        counts.push_back(1000);
+        counts.push_back(10000);
+        counts.push_back(MAX_PARTICLES);
+    }
+    for (size_t c = 0; c < counts.size(); c++)
+    {
+        size_t count = counts[c];
+        // Both updates must leave the same particles behind
+        ParticleSystem simd, scalar;
+        setupParticles(simd, static_cast<int>(count));
+        setupParticles(scalar, static_cast<int>(count));
+        fillParticles(simd, count);
+        fillParticles(scalar, count);
+        for (int f = 0; f < 30; f++)
+        {
+            updateParticles(simd, FRAME_DT);
+            updateParticlesScalar(scalar, FRAME_DT);
+        }
+        vector<array<float, 5>> simdLive = sortedParticles(simd);
+        vector<array<float, 5>> scalarLive = sortedParticles(scalar);
+        bool same = simdLive.size() == scalarLive.size();
+        for (size_t i = 0; i < simdLive.size() && same; i++)
+        {
+            same = fabs(simdLive[i][0] - scalarLive[i][0]) < 1e-5f &&
+                   fabs(simdLive[i][1] - scalarLive[i][1]) < 1e-3f && fabs(simdLive[i][2] - scalarLive[i][2]) < 1e-3f;
+        }
+        if (!same)
+        {
+            cerr << "updateParticles differs from updateParticlesScalar with " << count << " particles" << endl;
+            return 1;
+        }
+        double simdNs = timeUpdates(simd, count, frames, true);
+        double scalarNs = timeUpdates(scalar, count, frames, false);
+        cout << count << " particles: simd " << simdNs << " ns/particle (" << simdNs * count / 1e6
+             << " ms/frame), scalar " << scalarNs << " ns/particle, speedup " << scalarNs / simdNs << "x" << endl;
+    }
+    return 0;
+}
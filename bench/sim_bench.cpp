@@ -0,0 +1,87 @@
+// Headless simulation benchmark: runs the game logic with scripted inputs and reports ticks/sec
+// Usage: sim_bench [ticks] [rows cols] [threads]
+#include "simulation.h"
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+using namespace std;
+// Scripted player: always firing, sweeping left and right across the board
+Input scriptedInput(long long tick)
+{
+    Input input;
+    bool goingLeft = (tick / 600) % 2 == 0; // change direction every 2.5s of game time
+    input.left = goingLeft;
+    input.right = !goingLeft;
+    input.fire = true;
+    return input;
+}
+// Positive whole number, and nothing after it
+bool parseCount(const char text[], long long& value)
+{
+    char* end;
+    value = strtoll(text, &end, 10);
+    return end != text && *end == '\0' && value > 0;
+}
+int main(int argc, char* argv[])
+{
+    long long args[4] = {5000000, DEFAULT_ROWS, DEFAULT_COLS, 1}; // ticks, rows, cols, threads
+    bool valid = argc <= 5 && argc != 3; // rows and cols come together
+    for (int i = 1; i < argc && valid; i++)
+    {
+        valid = parseCount(argv[i], args[i - 1]) && (i == 1 || args[i - 1] <= 1000000); // sizes fit an int
+    }
+    valid = valid && args[3] <= MAX_BANDS; // more threads than bands would have nothing to do
+    if (!valid)
+    {
+        cerr << "Usage: sim_bench [ticks] [rows cols] [threads] (all above 0, threads at most " << MAX_BANDS << ")"
+             << endl;
+        return 1;
+    }
+    if (!validBoardSize(args[1], args[2]))
+    {
+        cerr << "board must be at least " << MIN_ROWS << "x1 and at most " << MAX_BOARD_CELLS << " cells" << endl;
+        return 1;
+    }
+    long long totalTicks = args[0];
+    int rows = static_cast<int>(args[1]); // bigger boards for load testing
+    int cols = static_cast<int>(args[2]);
+    int threads = static_cast<int>(args[3]);
+    setSimulationThreads(threads);
+    GameState game;
+    setupBoard(game, rows, cols);
+    seedGame(game, 1); // same run every time
+    newGame(game, 3, 0, 1);
+    long long eventCounts[EVENT_COUNT] = {0};
+    long long games = 1;
+    auto start = chrono::steady_clock::now();
+    for (long long tick = 0; tick < totalTicks; tick++)
+    {
+        const vector<GameEvent>& events = step(game, scriptedInput(tick));
+        bool gameEnded = false;
+        for (size_t i = 0; i < events.size(); i++)
+        {
+            eventCounts[events[i].type]++;
+            if (events[i].type == EVENT_GAME_OVER || events[i].type == EVENT_VICTORY)
+            {
+                gameEnded = true;
+            }
+        }
+        if (gameEnded) // keep the board busy: start over straight away
+        {
+            newGame(game, 3, 0, 1);
+            games++;
+        }
+    }
+    auto end = chrono::steady_clock::now();
+    double seconds = chrono::duration<double>(end - start).count();
+    cout << "board:        " << rows << "x" << cols << " (" << game.bands.size() << " column bands, " << threads << " threads)" << endl;
+    cout << "ticks:        " << totalTicks << " (" << totalTicks / TICK_RATE / 3600.0 << " h of game time)" << endl;
+    cout << "games:        " << games << endl;
+    cout << "shots:        " << eventCounts[EVENT_SHOT] << endl;
+    cout << "kills:        " << eventCounts[EVENT_KILL] << endl;
+    cout << "player hits:  " << eventCounts[EVENT_PLAYER_HIT] << endl;
+    cout << "level ups:    " << eventCounts[EVENT_LEVEL_UP] << endl;
+    cout << "elapsed:      " << seconds << " s" << endl;
+    cout << "ticks/sec:    " << (long long)(totalTicks / seconds) << endl;
+    return 0;
+}
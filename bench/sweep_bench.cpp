@@ -0,0 +1,294 @@
+// Gameplay sweep micro-benchmarks: times the movement passes, createExplosionEffect, clearEntities,
+// clearGrid and updateHitEffects on random boards at 5%, 25% and 75% occupancy, on the normal board and scaled-up ones.
+// Every case is measured several times and reported as the median with its spread, so two runs can be
+// compared; --format json / csv print the same numbers for scripts that track them over time.
+// Usage: sweep_bench [--format text|json|csv] [--samples N] [--min-time SECONDS] [--threads N] [ROWSxCOLS ...]
+#include "bench_boards.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <string>
+#include <vector>
+using namespace std;
+const int BOARD_COUNT = 16;      // random boards cycled through while timing
+const int LARGE_BOARD_COUNT = 2; // fewer of them past LARGE_BOARD_CELLS
+const int CASE_EXPLOSION = 5;
+const int CASE_HIT_EFFECTS = 8;
+const int CASE_COUNT = 9;
+const char caseNames[CASE_COUNT][24] = {"moveMeteors", "moveEnemies", "moveBosses", "moveBossBullets",
+                                        "moveBullets", "createExplosionEffect", "clearEntities", "clearGrid",
+                                        "updateHitEffects"};
+const int FORMAT_TEXT = 0;
+const int FORMAT_JSON = 1;
+const int FORMAT_CSV = 2;
+struct CaseResult
+{
+    int rows;
+    int cols;
+    float density;
+    int benchCase;
+    long long iterations; // per sample
+    double medianNs;      // per call, i.e. what the call adds to a tick
+    double minNs;
+    double spread;        // median absolute deviation / median
+};
+// randomBoard, with about as much of the hit effect capacity in use, at random ages
+void randomSweepBoard(GameState& game, float density)
+{
+    randomBoard(game, density);
+    HitEffectPool& effects = game.hitEffects;
+    effects.row.clear();
+    effects.col.clear();
+    effects.timer.clear();
+    for (int h = 0; h < effects.capacity; h++)
+    {
+        if (rand() < density * RAND_MAX)
+        {
+            effects.row.push_back(rand() % game.rows);
+            effects.col.push_back(rand() % game.cols);
+            effects.timer.push_back((rand() % 72) * TICK_DT); // 0 .. HIT_EFFECT_DURATION
+        }
+    }
+}
+// Put back what the case changed (not timed). Copies rather than rebuildPools, so the reset stays
+// cheap next to the sparse passes it sits between.
+void resetBoard(GameState& game, const GameState& original, int benchCase)
+{
+    game.hitEffects.row = original.hitEffects.row;
+    game.hitEffects.col = original.hitEffects.col;
+    game.hitEffects.timer = original.hitEffects.timer;
+    game.events.clear();
+    if (benchCase == CASE_EXPLOSION || benchCase == CASE_HIT_EFFECTS)
+    {
+        return;
+    }
+    game.grid.cells = original.grid.cells;
+    game.slot.cells = original.slot.cells;
+    for (size_t b = 0; b < game.bands.size(); b++)
+    {
+        for (int p = 0; p < POOL_COUNT; p++)
+        {
+            game.bands[b].pools[p].row = original.bands[b].pools[p].row;
+            game.bands[b].pools[p].col = original.bands[b].pools[p].col;
+            game.bands[b].pools[p].prevRow = original.bands[b].pools[p].prevRow;
+        }
+    }
+    game.collisions.clear();
+    game.isInvincible = false;
+    game.hasShield = false;
+    game.killCount = -1000000000; // no level ups getting in the way
+    game.bossMoveCounter = 100;   // bosses always fire
+    for (int i = 0; i < TIMER_COUNT; i++)
+    {
+        game.timers[i] = 1.0f; // every movement timer due
+    }
+}
+void runCase(GameState& game, int benchCase)
+{
+    if (benchCase == 0) moveMeteors(game);
+    else if (benchCase == 1) moveEnemies(game);
+    else if (benchCase == 2) moveBosses(game);
+    else if (benchCase == 3) moveBossBullets(game);
+    else if (benchCase == 4) moveBullets(game);
+    else if (benchCase == CASE_EXPLOSION) createExplosionEffect(game, game.rows / 2, game.cols / 2);
+    else if (benchCase == 6) clearEntities(game);
+    else if (benchCase == 7) clearGrid(game);
+    else updateHitEffects(game);
+}
+// Seconds spent in `iterations` calls. Each call gets a freshly reset board, a batch at a time, so only
+// the calls themselves are timed.
+double timeCase(vector<GameState>& batch, const vector<GameState>& originals, int benchCase, long long iterations)
+{
+    long long checksum = 0;
+    double seconds = 0.0;
+    int batchSize = static_cast<int>(batch.size());
+    for (long long done = 0; done < iterations; done += batchSize)
+    {
+        for (int b = 0; b < batchSize; b++)
+        {
+            resetBoard(batch[b], originals[b], benchCase);
+        }
+        auto start = chrono::steady_clock::now();
+        for (int b = 0; b < batchSize; b++)
+        {
+            runCase(batch[b], benchCase);
+        }
+        seconds += chrono::duration<double>(chrono::steady_clock::now() - start).count();
+        checksum += batch[done % batchSize].bands[0].pools[POOL_METEOR].row.size();
+        checksum += batch[0].hitEffects.row.size();
+    }
+    benchSink = checksum;
+    return seconds;
+}
+CaseResult measureCase(vector<GameState>& batch, const vector<GameState>& originals, int benchCase, int samples,
+                       double minTime)
+{
+    // Enough calls per sample that one sample takes minTime (timer resolution and noise stop mattering),
+    // estimated from a short run so calibrating costs about as much as one sample
+    long long iterations = static_cast<long long>(batch.size());
+    double seconds = timeCase(batch, originals, benchCase, iterations);
+    while (seconds < minTime / 10.0)
+    {
+        iterations *= 10;
+        seconds = timeCase(batch, originals, benchCase, iterations);
+    }
+    iterations = max(iterations, static_cast<long long>(iterations * minTime / seconds));
+    long long batchSize = static_cast<long long>(batch.size());
+    iterations = (iterations + batchSize - 1) / batchSize * batchSize; // timeCase runs whole batches
+    vector<double> ns(samples);
+    for (int s = 0; s < samples; s++)
+    {
+        ns[s] = timeCase(batch, originals, benchCase, iterations) * 1e9 / iterations;
+    }
+    sort(ns.begin(), ns.end());
+    CaseResult result;
+    result.rows = originals[0].rows;
+    result.cols = originals[0].cols;
+    result.benchCase = benchCase;
+    result.iterations = iterations;
+    result.medianNs = ns[samples / 2];
+    result.minNs = ns[0];
+    vector<double> deviations(samples);
+    for (int s = 0; s < samples; s++)
+    {
+        deviations[s] = fabs(ns[s] - result.medianNs);
+    }
+    sort(deviations.begin(), deviations.end());
+    result.spread = result.medianNs > 0.0 ? deviations[samples / 2] / result.medianNs : 0.0;
+    return result;
+}
+// Board cells covered per second (createExplosionEffect adds one effect without looking at the board, so
+// that one effect is its cell)
+double cellsPerSecond(const CaseResult& result)
+{
+    double cells = result.benchCase == CASE_EXPLOSION ? 1.0 : (double)result.rows * result.cols;
+    return result.medianNs > 0.0 ? cells / (result.medianNs * 1e-9) : 0.0;
+}
+void printResult(const CaseResult& result, int format, bool first)
+{
+    char line[256];
+    if (format == FORMAT_JSON)
+    {
+        snprintf(line, sizeof(line),
+                 "%s\n    {\"case\": \"%s\", \"rows\": %d, \"cols\": %d, \"density\": %.2f, \"iterations\": %lld, "
+                 "\"ns_per_tick\": %.2f, \"min_ns_per_tick\": %.2f, \"spread\": %.4f, \"cells_per_sec\": %.0f}",
+                 first ? "" : ",", caseNames[result.benchCase], result.rows, result.cols, result.density,
+                 result.iterations, result.medianNs, result.minNs, result.spread, cellsPerSecond(result));
+    }
+    else if (format == FORMAT_CSV)
+    {
+        snprintf(line, sizeof(line), "%s,%d,%d,%.2f,%lld,%.2f,%.2f,%.4f,%.0f\n", caseNames[result.benchCase],
+                 result.rows, result.cols, result.density, result.iterations, result.medianNs, result.minNs,
+                 result.spread, cellsPerSecond(result));
+    }
+    else
+    {
+        snprintf(line, sizeof(line), "  %-22s %12.1f ns/tick  (min %.1f, +-%.1f%%)  %10.3g cells/sec\n",
+                 caseNames[result.benchCase], result.medianNs, result.minNs, result.spread * 100.0,
+                 cellsPerSecond(result));
+    }
+    cout << line << flush;
+}
+int main(int argc, char* argv[])
+{
+    int format = FORMAT_TEXT;
+    int samples = 7;
+    double minTime = 0.005;
+    int threads = 1; // one thread by default, the band workers only add noise to single pass timings
+    vector<int> sizeRows, sizeCols;
+    for (int i = 1; i < argc; i++)
+    {
+        long long rows, cols;
+        if (strcmp(argv[i], "--format") == 0 && i + 1 < argc)
+        {
+            i++;
+            format = strcmp(argv[i], "json") == 0 ? FORMAT_JSON : strcmp(argv[i], "csv") == 0 ? FORMAT_CSV : FORMAT_TEXT;
+        }
+        else if (strcmp(argv[i], "--samples") == 0 && i + 1 < argc)
+        {
+            samples = max(1, atoi(argv[++i]));
+        }
+        else if (strcmp(argv[i], "--min-time") == 0 && i + 1 < argc)
+        {
+            minTime = atof(argv[++i]);
+        }
+        else if (strcmp(argv[i], "--threads") == 0 && i + 1 < argc)
+        {
+            threads = atoi(argv[++i]);
+            if (threads < 1 || threads > MAX_BANDS)
+            {
+                cerr << "--threads must be 1 to " << MAX_BANDS << endl;
+                return 1;
+            }
+        }
+        else if (sscanf(argv[i], "%lldx%lld", &rows, &cols) == 2 && validBoardSize(rows, cols))
+        {
+            sizeRows.push_back(static_cast<int>(rows));
+            sizeCols.push_back(static_cast<int>(cols));
+        }
+        else
+        {
+            cerr << "unknown argument " << argv[i] << endl;
+            return 1;
+        }
+    }
+    if (sizeRows.empty()) // the normal board, then scaled up
+    {
+        const int defaultSizes[4][2] = {{DEFAULT_ROWS, DEFAULT_COLS}, {100, 100}, {300, 300}, {1000, 1000}};
+        for (int s = 0; s < 4; s++)
+        {
+            sizeRows.push_back(defaultSizes[s][0]);
+            sizeCols.push_back(defaultSizes[s][1]);
+        }
+    }
+    setSimulationThreads(threads);
+    if (format == FORMAT_JSON)
+    {
+        cout << "{\"benchmark\": \"sweep_bench\", \"samples\": " << samples << ", \"threads\": " << threads
+             << ", \"results\": [";
+    }
+    else if (format == FORMAT_CSV)
+    {
+        cout << "case,rows,cols,density,iterations,ns_per_tick,min_ns_per_tick,spread,cells_per_sec" << endl;
+    }
+    bool first = true;
+    for (size_t s = 0; s < sizeRows.size(); s++)
+    {
+        int rows = sizeRows[s];
+        int cols = sizeCols[s];
+        int boardCount = benchBoardCount(rows, cols, BOARD_COUNT, LARGE_BOARD_COUNT);
+        srand(1); // same boards every run
+        GameState game;
+        setupBoard(game, rows, cols);
+        newGame(game, 3, 0, MAX_LEVEL);
+        vector<GameState> originals(boardCount, game);
+        vector<GameState> batch(boardCount, game);
+        for (int d = 0; d < DENSITY_COUNT; d++)
+        {
+            for (int b = 0; b < boardCount; b++)
+            {
+                randomSweepBoard(originals[b], densities[d]);
+            }
+            if (format == FORMAT_TEXT)
+            {
+                cout << endl << "board " << rows << "x" << cols << ", density " << densities[d] * 100 << "%" << endl;
+            }
+            for (int benchCase = 0; benchCase < CASE_COUNT; benchCase++)
+            {
+                CaseResult result = measureCase(batch, originals, benchCase, samples, minTime);
+                result.density = densities[d];
+                printResult(result, format, first);
+                first = false;
+            }
+        }
+    }
+    if (format == FORMAT_JSON)
+    {
+        cout << "\n]}" << endl;
+    }
+    return 0;
+}
@@ -0,0 +1,248 @@
+#include "bitboard.h"
+int countBits(uint64_t mask)
+{
+    int count = 0;
+    while (mask != 0)
+    {
+        mask &= mask - 1; // drop the lowest set bit
+        count++;
+    }
+    return count;
+}
+// First word of a row of one type
+uint64_t* rowMask(BitBoard& board, int type, int row)
+{
+    return &board.masks[type][row * board.words];
+}
+void clearCollisions(const BitBoard& board, BitCollisions& hits)
+{
+    hits.playerHits = 0;
+    hits.meteorsShot = 0;
+    hits.enemiesShot = 0;
+    hits.bossesShot = 0;
+    hits.bossBulletsShot = 0;
+    hits.explosions.assign(board.rows * board.words, 0);
+}
+void gridToBitBoard(const GameState& game, BitBoard& board)
+{
+    board.rows = game.rows;
+    board.words = (game.cols + 63) / 64;
+    for (int t = 0; t < BIT_TYPES; t++)
+    {
+        board.masks[t].assign(board.rows * board.words, 0);
+    }
+    for (int r = 0; r < game.rows; r++)
+    {
+        for (int c = 0; c < game.cols; c++)
+        {
+            int code = game.grid[r][c];
+            if (code >= 1 && code <= 6)
+            {
+                rowMask(board, code - 1, r)[c / 64] |= 1ull << (c % 64);
+            }
+        }
+    }
+}
+void bitBoardToGrid(const BitBoard& board, GameState& game)
+{
+    for (int r = 0; r < game.rows; r++)
+    {
+        for (int c = 0; c < game.cols; c++)
+        {
+            game.grid[r][c] = 0;
+            for (int t = 0; t < BIT_TYPES; t++)
+            {
+                if (board.masks[t][r * board.words + c / 64] & (1ull << (c % 64)))
+                {
+                    game.grid[r][c] = t + 1;
+                }
+            }
+        }
+    }
+    rebuildPools(game);
+}
+// Meteors and enemies behave the same: fall one row, blocked by anything that is not their own kind
+void fallOneRow(BitBoard& board, int type, BitCollisions& hits, int& shotCounter)
+{
+    // Rows are done bottom to top, so the row below has already been emptied of this type
+    for (int r = board.rows - 2; r >= 0; r--)
+    {
+        uint64_t* movers = rowMask(board, type, r);
+        uint64_t* moversBelow = rowMask(board, type, r + 1);
+        uint64_t* player = rowMask(board, BIT_PLAYER, r + 1);
+        uint64_t* bullets = rowMask(board, BIT_BULLET, r + 1);
+        uint64_t* explosions = &hits.explosions[(r + 1) * board.words];
+        for (int w = 0; w < board.words; w++)
+        {
+            uint64_t moving = movers[w];
+            movers[w] = 0;
+            if (moving == 0)
+            {
+                continue;
+            }
+            uint64_t below = 0; // everything in the row below apart from this type
+            for (int t = 0; t < BIT_TYPES; t++)
+            {
+                if (t != type)
+                {
+                    below |= rowMask(board, t, r + 1)[w];
+                }
+            }
+            uint64_t shot = moving & bullets[w];
+            hits.playerHits += countBits(moving & player[w]);
+            shotCounter += countBits(shot);
+            explosions[w] |= shot;
+            bullets[w] &= ~shot;
+            moversBelow[w] = moving & ~below;
+        }
+    }
+}
+void bitMoveMeteors(BitBoard& board, BitCollisions& hits)
+{
+    uint64_t* bottom = rowMask(board, BIT_METEOR, board.rows - 1);
+    for (int w = 0; w < board.words; w++)
+    {
+        bottom[w] = 0; // goes below screen
+    }
+    fallOneRow(board, BIT_METEOR, hits, hits.meteorsShot);
+}
+void bitMoveEnemies(BitBoard& board, BitCollisions& hits)
+{
+    uint64_t* bottom = rowMask(board, BIT_ENEMY, board.rows - 1);
+    for (int w = 0; w < board.words; w++)
+    {
+        hits.playerHits += countBits(bottom[w]); // enemy reached bottom
+        bottom[w] = 0;
+    }
+    fallOneRow(board, BIT_ENEMY, hits, hits.enemiesShot);
+}
+void bitMoveBosses(BitBoard& board, BitCollisions& hits, bool fire)
+{
+    uint64_t* bottom = rowMask(board, BIT_BOSS, board.rows - 1);
+    for (int w = 0; w < board.words; w++)
+    {
+        hits.playerHits += countBits(bottom[w]); // bottom of screen
+        bottom[w] = 0;
+    }
+    for (int r = board.rows - 2; r >= 0; r--)
+    {
+        uint64_t* bosses = rowMask(board, BIT_BOSS, r);
+        uint64_t* bossesBelow = rowMask(board, BIT_BOSS, r + 1);
+        uint64_t* player = rowMask(board, BIT_PLAYER, r + 1);
+        uint64_t* bullets = rowMask(board, BIT_BULLET, r + 1);
+        uint64_t* meteors = rowMask(board, BIT_METEOR, r + 1);
+        uint64_t* enemies = rowMask(board, BIT_ENEMY, r + 1);
+        uint64_t* bossBullets = rowMask(board, BIT_BOSS_BULLET, r + 1);
+        uint64_t* explosions = &hits.explosions[(r + 1) * board.words];
+        for (int w = 0; w < board.words; w++)
+        {
+            uint64_t moving = bosses[w];
+            bosses[w] = 0;
+            if (moving == 0)
+            {
+                continue;
+            }
+            uint64_t shot = moving & bullets[w];
+            uint64_t landed = moving & ~(player[w] | bullets[w]);
+            hits.playerHits += countBits(moving & player[w]);
+            hits.bossesShot += countBits(shot);
+            explosions[w] |= shot;
+            bullets[w] &= ~shot;
+            // Bosses crush meteors, enemies and boss bullets in their way
+            meteors[w] &= ~landed;
+            enemies[w] &= ~landed;
+            bossBullets[w] &= ~landed;
+            bossesBelow[w] = landed;
+        }
+    }
+    if (fire) // a bullet just below every boss with room for it
+    {
+        for (int r = 0; r < board.rows - 1; r++)
+        {
+            uint64_t* bosses = rowMask(board, BIT_BOSS, r);
+            uint64_t* bossBullets = rowMask(board, BIT_BOSS_BULLET, r + 1);
+            for (int w = 0; w < board.words; w++)
+            {
+                uint64_t occupied = 0;
+                for (int t = 0; t < BIT_TYPES; t++)
+                {
+                    occupied |= rowMask(board, t, r + 1)[w];
+                }
+                bossBullets[w] |= bosses[w] & ~occupied;
+            }
+        }
+    }
+}
+void bitMoveBossBullets(BitBoard& board, BitCollisions& hits)
+{
+    uint64_t* bottom = rowMask(board, BIT_BOSS_BULLET, board.rows - 1);
+    for (int w = 0; w < board.words; w++)
+    {
+        bottom[w] = 0; // remove when below screen
+    }
+    for (int r = board.rows - 2; r >= 0; r--)
+    {
+        uint64_t* bossBullets = rowMask(board, BIT_BOSS_BULLET, r);
+        uint64_t* bossBulletsBelow = rowMask(board, BIT_BOSS_BULLET, r + 1);
+        uint64_t* player = rowMask(board, BIT_PLAYER, r + 1);
+        uint64_t* bullets = rowMask(board, BIT_BULLET, r + 1);
+        uint64_t* bosses = rowMask(board, BIT_BOSS, r + 1);
+        uint64_t* meteors = rowMask(board, BIT_METEOR, r + 1);
+        uint64_t* enemies = rowMask(board, BIT_ENEMY, r + 1);
+        uint64_t* explosions = &hits.explosions[(r + 1) * board.words];
+        for (int w = 0; w < board.words; w++)
+        {
+            uint64_t moving = bossBullets[w];
+            bossBullets[w] = 0;
+            if (moving == 0)
+            {
+                continue;
+            }
+            uint64_t playerHit = moving & player[w];
+            uint64_t landed = moving & ~(player[w] | bullets[w] | bosses[w]);
+            hits.playerHits += countBits(playerHit);
+            explosions[w] |= playerHit;
+            // bullet moves through meteors and enemies
+            meteors[w] &= ~landed;
+            enemies[w] &= ~landed;
+            bossBulletsBelow[w] = landed;
+        }
+    }
+}
+void bitMoveBullets(BitBoard& board, BitCollisions& hits)
+{
+    uint64_t* top = rowMask(board, BIT_BULLET, 0);
+    for (int w = 0; w < board.words; w++)
+    {
+        top[w] = 0; // goes above screen
+    }
+    const int targets[4] = {BIT_METEOR, BIT_ENEMY, BIT_BOSS, BIT_BOSS_BULLET};
+    int* counters[4] = {&hits.meteorsShot, &hits.enemiesShot, &hits.bossesShot, &hits.bossBulletsShot};
+    // Rows are done top to bottom, so the row above has already been emptied of bullets
+    for (int r = 1; r < board.rows; r++)
+    {
+        uint64_t* bullets = rowMask(board, BIT_BULLET, r);
+        uint64_t* bulletsAbove = rowMask(board, BIT_BULLET, r - 1);
+        uint64_t* explosions = &hits.explosions[(r - 1) * board.words];
+        for (int w = 0; w < board.words; w++)
+        {
+            uint64_t moving = bullets[w];
+            bullets[w] = 0;
+            if (moving == 0)
+            {
+                continue;
+            }
+            uint64_t blocked = rowMask(board, BIT_PLAYER, r - 1)[w];
+            for (int i = 0; i < 4; i++)
+            {
+                uint64_t& above = rowMask(board, targets[i], r - 1)[w];
+                uint64_t shot = moving & above;
+                blocked |= above;
+                *counters[i] += countBits(shot);
+                explosions[w] |= shot;
+                above &= ~shot;
+            }
+            bulletsAbove[w] = moving & ~blocked;
+        }
+    }
+}
@@ -0,0 +1,43 @@
+// Bitboard representation of the game board
+// One bitmask per entity type per row (bit c of word c / 64 = column c), so a normal 15 column board is
+// a single 64-bit word per row and wider boards just use more words. A move down is a row shift and
+// every collision test is an AND between two masks. The passes below produce the same board as the
+// grid passes in simulation.cpp and report what collided instead of applying the scoring rules.
+#pragma once
+#include <cstdint>
+#include <vector>
+#include "simulation.h"
+// Entity types: grid code - 1
+const int BIT_PLAYER = 0;
+const int BIT_METEOR = 1;
+const int BIT_BULLET = 2;
+const int BIT_ENEMY = 3;
+const int BIT_BOSS = 4;
+const int BIT_BOSS_BULLET = 5;
+const int BIT_TYPES = 6;
+struct BitBoard
+{
+    int rows;
+    int words;                              // 64-bit words per row
+    std::vector<uint64_t> masks[BIT_TYPES]; // rows * words each, row by row
+};
+// What one pass ran into
+struct BitCollisions
+{
+    int playerHits;            // entities that hit the player
+    int meteorsShot;           // shot down by the player's bullets (or shooting them down)
+    int enemiesShot;
+    int bossesShot;
+    int bossBulletsShot;
+    std::vector<uint64_t> explosions; // cells where something blew up (same layout as the masks)
+};
+int countBits(uint64_t mask);
+void clearCollisions(const BitBoard& board, BitCollisions& hits);
+void gridToBitBoard(const GameState& game, BitBoard& board);
+void bitBoardToGrid(const BitBoard& board, GameState& game);
+// Same moves as moveMeteors, moveEnemies, moveBosses (plus firing), moveBossBullets and moveBullets
+void bitMoveMeteors(BitBoard& board, BitCollisions& hits);
+void bitMoveEnemies(BitBoard& board, BitCollisions& hits);
+void bitMoveBosses(BitBoard& board, BitCollisions& hits, bool fire);
+void bitMoveBossBullets(BitBoard& board, BitCollisions& hits);
+void bitMoveBullets(BitBoard& board, BitCollisions& hits);
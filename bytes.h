@@ -0,0 +1,34 @@
+// Byte helpers shared by every file format (saves, replays, snapshots, the asset pack and the PCM cache):
+// little-endian integers, so the files are the same on every machine, and the FNV-1a hash they are checked
+// and named with. Header only, the asset pack library does not link the simulation.
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+const uint64_t FNV1A_START = 0xCBF29CE484222325ull;
+// Pass the last hash back in to carry on over more data
+inline uint64_t fnv1a(const void* data, size_t size, uint64_t hash = FNV1A_START)
+{
+    const uint8_t* bytes = static_cast<const uint8_t*>(data);
+    for (size_t i = 0; i < size; i++)
+    {
+        hash = (hash ^ bytes[i]) * 0x100000001B3ull;
+    }
+    return hash;
+}
+inline void putLittleEndian(std::vector<uint8_t>& bytes, uint64_t value, int size)
+{
+    for (int i = 0; i < size; i++)
+    {
+        bytes.push_back(static_cast<uint8_t>((value >> (8 * i)) & 0xFF));
+    }
+}
+inline uint64_t getLittleEndian(const uint8_t* bytes, int size) // the caller checks there are size bytes
+{
+    uint64_t value = 0;
+    for (int i = 0; i < size; i++)
+    {
+        value |= static_cast<uint64_t>(bytes[i]) << (8 * i);
+    }
+    return value;
+}
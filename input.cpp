@@ -0,0 +1,90 @@
+#include "input.h"
+using namespace std;
+void resetInput(InputBuffer& buffer)
+{
+    buffer.events.clear();
+    for (int k = 0; k < INPUT_KEY_COUNT; k++)
+    {
+        buffer.held[k] = false;
+        buffer.pending[k].clear();
+    }
+    buffer.used.clear();
+}
+void pushInput(InputBuffer& buffer, int key, bool down, double time)
+{
+    InputEvent event = {key, down, time};
+    buffer.events.push_back(event);
+}
+void releaseAllInput(InputBuffer& buffer, double time)
+{
+    for (int k = 0; k < INPUT_KEY_COUNT; k++)
+    {
+        pushInput(buffer, k, false, time);
+    }
+}
+// Key repeat from the OS arrives as more presses of a key that is already down, those are not new presses
+void applyEvents(InputBuffer& buffer)
+{
+    for (size_t i = 0; i < buffer.events.size(); i++)
+    {
+        const InputEvent& event = buffer.events[i];
+        vector<InputEvent>& presses = buffer.pending[event.key];
+        if (event.down && !buffer.held[event.key] && static_cast<int>(presses.size()) < MAX_PENDING_PRESSES)
+        {
+            presses.push_back(event);
+        }
+        buffer.held[event.key] = event.down;
+    }
+    buffer.events.clear();
+}
+// Same sums as cooldownReady, so this is exactly the tick movePlayer acts on
+bool cooldownDue(const GameState& game, int timer, float cooldown)
+{
+    float time = game.timers[timer];
+    if (time < cooldown)
+    {
+        time += TICK_DT;
+    }
+    return time >= cooldown;
+}
+void usePress(InputBuffer& buffer, int key)
+{
+    if (!buffer.pending[key].empty())
+    {
+        buffer.used.push_back(buffer.pending[key].front());
+        buffer.pending[key].erase(buffer.pending[key].begin());
+    }
+}
+Input takeTickInput(InputBuffer& buffer, const GameState& game)
+{
+    applyEvents(buffer);
+    Input input;
+    input.left = buffer.held[INPUT_LEFT] || !buffer.pending[INPUT_LEFT].empty();
+    input.right = buffer.held[INPUT_RIGHT] || !buffer.pending[INPUT_RIGHT].empty();
+    input.fire = buffer.held[INPUT_FIRE] || !buffer.pending[INPUT_FIRE].empty();
+    buffer.used.clear();
+    // A press is used up by the first tick that could act on it (even against the edge of the board, or it
+    // would move the ship much later, once it is away from the edge). Left wins over right like in movePlayer.
+    if (cooldownDue(game, TIMER_PLAYER_MOVE, MOVE_COOLDOWN))
+    {
+        usePress(buffer, input.left ? INPUT_LEFT : INPUT_RIGHT);
+        if (input.left) // a right tap loses to left now, kept it would move the ship long after it was let go
+        {
+            buffer.pending[INPUT_RIGHT].clear();
+        }
+    }
+    if (cooldownDue(game, TIMER_BULLET_FIRE, BULLET_FIRE_COOLDOWN))
+    {
+        usePress(buffer, INPUT_FIRE);
+    }
+    return input;
+}
+void clearPresses(InputBuffer& buffer)
+{
+    applyEvents(buffer);
+    for (int k = 0; k < INPUT_KEY_COUNT; k++)
+    {
+        buffer.pending[k].clear();
+    }
+    buffer.used.clear();
+}
@@ -0,0 +1,35 @@
+// Player input buffer
+// Key presses and releases come in from the window's event queue, stamped with when they were taken off it,
+// and every tick takes its Input from here. A key counts for a tick if it was down at any point since the
+// tick before, and presses the game has not acted on yet (move or fire cooldown still running) keep it down
+// for one cooldown-ready tick each. So a tap shorter than a frame, or than a cooldown, is never lost, and a
+// fresh press acts on the very next tick. The repeat rules for keys held down are movePlayer's cooldowns, in
+// simulation time.
+#pragma once
+#include <vector>
+#include "simulation.h"
+const int INPUT_LEFT = 0;
+const int INPUT_RIGHT = 1;
+const int INPUT_FIRE = 2;
+const int INPUT_KEY_COUNT = 3;
+const int MAX_PENDING_PRESSES = 4; // mashing faster than the cooldowns only queues this many
+struct InputEvent
+{
+    int key;        // INPUT_*
+    bool down;
+    double time; // seconds, on the caller's clock
+};
+struct InputBuffer
+{
+    std::vector<InputEvent> events; // not taken by a tick yet, oldest first
+    bool held[INPUT_KEY_COUNT];
+    std::vector<InputEvent> pending[INPUT_KEY_COUNT]; // presses not acted on yet, oldest first
+    std::vector<InputEvent> used;                     // presses the last tick could act on (latency.h)
+};
+void resetInput(InputBuffer& buffer);
+void pushInput(InputBuffer& buffer, int key, bool down, double time);
+void releaseAllInput(InputBuffer& buffer, double time); // window lost focus: the releases will never come
+// Input for the next tick of this game (call it right before step)
+Input takeTickInput(InputBuffer& buffer, const GameState& game);
+// Nothing is ticking (menus, pause): keep track of what is held, forget presses so they don't act later
+void clearPresses(InputBuffer& buffer);
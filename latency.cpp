@@ -0,0 +1,99 @@
+#include "latency.h"
+#include <algorithm>
+#include <cstdio>
+using namespace std;
+const char* const ACTION_NAMES[ACTION_COUNT] = {"move", "fire"};
+void latencyTick(LatencyTracker& tracker, const InputBuffer& buffer, int shipColBefore, const GameState& game,
+                 const vector<GameEvent>& events, double now)
+{
+    bool shot = false;
+    for (size_t i = 0; i < events.size(); i++)
+    {
+        shot = shot || events[i].type == EVENT_SHOT;
+    }
+    // A press against the edge of the board or into a blocked cell shows nothing, there is nothing to time
+    for (size_t i = 0; i < buffer.used.size(); i++)
+    {
+        int action = buffer.used[i].key == INPUT_FIRE ? ACTION_FIRE : ACTION_MOVE;
+        if ((action == ACTION_MOVE && game.spaceshipCol == shipColBefore) || (action == ACTION_FIRE && !shot))
+        {
+            continue;
+        }
+        LatencySample sample = {action, buffer.used[i].time, now, -1.0, -1.0};
+        tracker.waiting.push_back(sample);
+    }
+}
+void latencyDrawn(LatencyTracker& tracker, double now)
+{
+    for (size_t i = 0; i < tracker.waiting.size(); i++)
+    {
+        if (tracker.waiting[i].drawn < 0.0)
+        {
+            tracker.waiting[i].drawn = now;
+        }
+    }
+}
+void latencyDisplayed(LatencyTracker& tracker, double now)
+{
+    size_t kept = 0;
+    for (size_t i = 0; i < tracker.waiting.size(); i++)
+    {
+        LatencySample& sample = tracker.waiting[i];
+        if (sample.drawn >= 0.0)
+        {
+            sample.displayed = now;
+            tracker.samples.push_back(sample);
+        }
+        else
+        {
+            tracker.waiting[kept++] = sample; // acted on after this frame was drawn, shown next frame
+        }
+    }
+    tracker.waiting.resize(kept);
+}
+void latencyDiscardPending(LatencyTracker& tracker)
+{
+    tracker.waiting.clear();
+}
+// Nearest rank percentile of a sorted list, in milliseconds
+double percentileMs(const vector<double>& sorted, int percent)
+{
+    size_t rank = (sorted.size() * percent + 99) / 100;
+    return sorted[max<size_t>(rank, 1) - 1] * 1000.0;
+}
+void printLatencyReport(const LatencyTracker& tracker, bool tickTimes)
+{
+    const int STAGES = 4;
+    const char stageNames[STAGES][24] = {"press -> tick", "tick -> draw", "draw -> display", "press -> display"};
+    printf("Input latency (ms)            p50      p95      p99\n");
+    for (int action = 0; action < ACTION_COUNT; action++)
+    {
+        vector<double> stages[STAGES];
+        for (size_t i = 0; i < tracker.samples.size(); i++)
+        {
+            const LatencySample& sample = tracker.samples[i];
+            if (sample.action == action)
+            {
+                stages[0].push_back(sample.ticked - sample.pressed);
+                stages[1].push_back(sample.drawn - sample.ticked);
+                stages[2].push_back(sample.displayed - sample.drawn);
+                stages[3].push_back(sample.displayed - sample.pressed);
+            }
+        }
+        printf("  %s (%d presses)\n", ACTION_NAMES[action], static_cast<int>(stages[0].size()));
+        if (stages[0].empty())
+        {
+            continue;
+        }
+        for (int s = 0; s < STAGES; s++)
+        {
+            if (s == 1 && !tickTimes)
+            {
+                continue;
+            }
+            sort(stages[s].begin(), stages[s].end());
+            printf("    %-22s %8.2f %8.2f %8.2f\n", stageNames[s], percentileMs(stages[s], 50),
+                   percentileMs(stages[s], 95), percentileMs(stages[s], 99));
+        }
+    }
+}
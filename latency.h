@@ -0,0 +1,34 @@
+// Input latency measurement
+// Follows every key press the game acts on, from the time the press arrived through the tick that acted on
+// it, the frame that drew the result and the display of that frame, and reports the p50/p95/p99 of each
+// step per action. The game measures real frames (--latency-report); latency_harness drives the same code
+// with scripted key presses on a simulated frame clock, so its numbers come out the same on every machine.
+// Times are seconds on whatever clock the caller stamps its input with.
+#pragma once
+#include <vector>
+#include "input.h"
+const int ACTION_MOVE = 0; // a press that moved the ship
+const int ACTION_FIRE = 1; // a press that put a new bullet above the ship
+const int ACTION_COUNT = 2;
+struct LatencySample
+{
+    int action;
+    double pressed;   // arrived at the input buffer
+    double ticked;    // the tick that acted on it returned
+    double drawn;     // the frame showing it was submitted (-1 = not yet)
+    double displayed; // that frame was on screen
+};
+struct LatencyTracker
+{
+    std::vector<LatencySample> waiting; // acted on, not displayed yet
+    std::vector<LatencySample> samples;
+};
+// After each step: the presses the tick used that really did something (shipColBefore = spaceshipCol before
+// the step, events = what the step reported)
+void latencyTick(LatencyTracker& tracker, const InputBuffer& buffer, int shipColBefore, const GameState& game,
+                 const std::vector<GameEvent>& events, double now);
+void latencyDrawn(LatencyTracker& tracker, double now);     // board and HUD for this frame submitted
+void latencyDisplayed(LatencyTracker& tracker, double now); // display() returned
+void latencyDiscardPending(LatencyTracker& tracker);         // acted on but never going to be drawn
+// tickTimes = false leaves out tick -> draw, for callers whose ticks take no measured time
+void printLatencyReport(const LatencyTracker& tracker, bool tickTimes);
@@ -1,21 +1,29 @@
 // SFML libraries
 #include <SFML/Graphics.hpp>
 #include <SFML/Audio.hpp>
+// Game logic
+#include "simulation.h"
+#include "render.h"
+#include "atlas.h"
+#include "assets.h"
+#include "pack.h"
+#include "replay.h"
+#include "savegame.h"
+#include "voices.h"
+#include "profiler.h"
+#include "input.h"
+#include "latency.h"
 // C++ libraries
 #include <iostream>
-#include <fstream>
 #include <cstdlib>
-#include <ctime>
+#include <chrono>
+#include <cstring>
+#include <algorithm>
+#include <thread>
+#include <deque>
 // namespaces
 using namespace std;
 using namespace sf;
-// Grid Setup
-const int ROWS = 23;
-const int COLS = 15;
-const int CELL_SIZE = 40;
-const int MARGIN = 40;                                               // Margin around the grid
-const float BULLET_OFFSET_X = (CELL_SIZE - CELL_SIZE * 0.3f) / 2.0f; // Center bullets horizontally
-const float SHIELD_OFFSET = CELL_SIZE * -0.15f;                      // Center shield overlay
 // Game States
 const int STATE_MENU = 0;
 const int STATE_PLAYING = 1;
@@ -24,291 +32,492 @@ const int STATE_GAME_OVER = 3;
 const int STATE_LEVEL_UP = 4;
 const int STATE_VICTORY = 5;
 const int STATE_PAUSED = 6;
+const int STATE_SAVE_SLOTS = 7; // pick a slot to save to (from the pause menu) or load from (main menu)
+const float MAX_FRAME_TIME = 0.25f; // longest frame we catch up on (avoids a spiral after a stall)
+// Some drivers ignore the vsync request and the loop then spins flat out. If the first frames come back
+// faster than any display refreshes, the frame rate is capped instead (SFML can't tell us the refresh rate).
+const int VSYNC_CHECK_FRAMES = 120;
+const float MIN_VSYNC_FRAME_TIME = 1.0f / 400.0f;
+const int VSYNC_FALLBACK_FPS = 144;
 // Helper functions:
-void saveHighScoreAndGameOver(int& score, int& highScore, char saveFile[], bool& hasSavedGame, int& currentState, int& selectedMenuItem, Sound& loseSound)
+bool anySavedGame() // from what the slots are known to hold, no file is read
+{
+    for (int slot = 0; slot < SAVE_SLOTS; slot++)
+    {
+        if (slotInUse(slot))
+        {
+            return true;
+        }
+    }
+    return false;
+}
+// Slot menu: one line per slot with what is in it, then Back
+void updateSlotTexts(Text items[], float centerX, RenderStats& stats)
+{
+    for (int slot = 0; slot <= SAVE_SLOTS; slot++)
+    {
+        char buffer[80];
+        SaveSummary summary;
+        if (slot == SAVE_SLOTS)
+        {
+            sprintf(buffer, "Back");
+        }
+        else if (readSaveSummary(slot, summary))
+        {
+            sprintf(buffer, "Slot %d: Level %d  Score %d  Lives %d", slot + 1, summary.level, summary.score, summary.lives);
+        }
+        else
+        {
+            sprintf(buffer, "Slot %d: Empty", slot + 1);
+        }
+        items[slot].setString(buffer);
+        items[slot].setPosition(centerX - items[slot].getLocalBounds().width / 2.0f, 260 + slot * 56);
+        stats.textRebuilds++;
+    }
+}
+void saveHighScoreAndGameOver(int& score, int& highScore, int& activeSlot, bool& hasSavedGame, int& currentState, int& selectedMenuItem, VoicePool& voices)
 {
     if (score > highScore)
     {
         highScore = score;
     }
-    
-    ofstream outputFile(saveFile);
-    if (outputFile.is_open())
+    queueHighScore(highScore); // written in the background, the frame carries on
+    if (activeSlot >= 0) // finished games can't be loaded again
     {
-        outputFile << highScore << " 0 0 0";
-        outputFile.close();
-        hasSavedGame = false;
+        queueDeleteSave(activeSlot);
+        activeSlot = -1;
+        hasSavedGame = anySavedGame();
     }
     
-    loseSound.play();
+    playSound(voices, SOUND_LOSE);
     currentState = STATE_GAME_OVER;
     selectedMenuItem = 0;
 }
-void saveHighScoreAndVictory(int& score, int& highScore, char saveFile[], bool& hasSavedGame, int& currentState, int& selectedMenuItem, Sound& winSound)
+void saveHighScoreAndVictory(int& score, int& highScore, int& activeSlot, bool& hasSavedGame, int& currentState, int& selectedMenuItem, VoicePool& voices)
 {
     if (score > highScore)
     {
         highScore = score;
     }
-    
-    ofstream outputFile(saveFile);
-    if (outputFile.is_open())
+    queueHighScore(highScore); // written in the background, the frame carries on
+    if (activeSlot >= 0) // finished games can't be loaded again
     {
-        outputFile << highScore << " 0 0 0";
-        outputFile.close();
-        hasSavedGame = false;
+        queueDeleteSave(activeSlot);
+        activeSlot = -1;
+        hasSavedGame = anySavedGame();
     }
     
-    winSound.play();
+    playSound(voices, SOUND_WIN);
     currentState = STATE_VICTORY;
     selectedMenuItem = 0;
 }
-void createExplosionEffect(int row, int col, int hitEffectRow[], int hitEffectCol[], float hitEffectTimer[], bool hitEffectActive[], int maxEffects)
+// Oldest key press no screen has handled yet (false if there is none)
+bool takeKey(deque<Keyboard::Key>& keys, Keyboard::Key& key)
 {
-    for (int i = 0; i < maxEffects; i++)
+    if (keys.empty())
     {
-        if (!hitEffectActive[i])
-        {
-            hitEffectRow[i] = row;
-            hitEffectCol[i] = col;
-            hitEffectTimer[i] = 0.0f;
-            hitEffectActive[i] = true;
-            break;
-        }
+        return false;
     }
+    key = keys.front();
+    keys.pop_front();
+    return true;
 }
-void clearGrid(int grid[][15])
+// Which player control a key is (-1 = none)
+int gameplayKey(Keyboard::Key code)
 {
-    for (int r = 0; r < ROWS; r++)
-    {
-        for (int c = 0; c < COLS; c++)
-        {
-            grid[r][c] = 0;
-        }
-    }
+    if (code == Keyboard::Left || code == Keyboard::A)
+        return INPUT_LEFT;
+    if (code == Keyboard::Right || code == Keyboard::D)
+        return INPUT_RIGHT;
+    if (code == Keyboard::Space)
+        return INPUT_FIRE;
+    return -1;
 }
-void clearEntities(int grid[][15])
+void setMenuColors(Text items[], int count, int selectedIndex)
 {
-    for (int r = 0; r < ROWS; r++)
+    for (int i = 0; i < count; i++)
     {
-        for (int c = 0; c < COLS; c++)
-        {
-            if (grid[r][c] >= 2 && grid[r][c] <= 6)
-            {
-                grid[r][c] = 0;
-            }
-        }
+        items[i].setFillColor(i == selectedIndex ? Color::Yellow : Color::White);
     }
 }
-void restartAllClocks(Clock& meteorSpawn, Clock& meteorMove, Clock& enemySpawn, Clock& enemyMove, Clock& bossSpawn, Clock& bossMove, Clock& bossBulletMove, Clock& bulletMove, Clock& shieldSpawn, Clock& shieldMove)
+// Seed for a new game: different every time, and kept in the recording so the game can be replayed
+uint64_t newSeed()
 {
-    meteorSpawn.restart();
-    meteorMove.restart();
-    enemySpawn.restart();
-    enemyMove.restart();
-    bossSpawn.restart();
-    bossMove.restart();
-    bossBulletMove.restart();
-    bulletMove.restart();
-    shieldSpawn.restart();
-    shieldMove.restart();
+    return static_cast<uint64_t>(chrono::high_resolution_clock::now().time_since_epoch().count());
 }
-void resetSpaceship(int grid[][15], int& spaceshipCol)
+// Every game the player drives starts here: a fresh one, or one just loaded from a save (resumed). It is
+// recorded from this point on, and a replay that was playing stops driving the game. Debris from the last
+// game goes.
+void startPlayerGame(GameState& game, Replay& recording, bool resumed, int keyframeInterval, bool& replaying,
+                     long long& replayTick, bool& restartPending, ParticleSystem& particles)
 {
-    grid[ROWS - 1][spaceshipCol] = 0;
-    spaceshipCol = COLS / 2;
-    grid[ROWS - 1][spaceshipCol] = 1;
-}
-void setMenuColors(Text items[], int count, int selectedIndex)
-{
-    for (int i = 0; i < count; i++)
+    clearParticles(particles);
+    replaying = false;
+    replayTick = 0;
+    restartPending = false;
+    if (resumed)
     {
-        items[i].setFillColor(i == selectedIndex ? Color::Yellow : Color::White);
+        resumeRecording(recording, game, keyframeInterval);
+    }
+    else
+    {
+        startRecording(recording, game, newSeed(), 3, 0, 1, keyframeInterval);
     }
 }
-bool loadTexture(Texture& texture, const char path[])
+bool setupSprite(Sprite& sprite, const TextureAtlas& atlas, const char name[], float width, float height)
 {
-    if (!texture.loadFromFile(path))
+    IntRect rect;
+    if (!findAtlasRect(atlas, name, rect))
     {
-        cerr << "Failed to load " << path << endl;
         return false;
     }
+    sprite.setTexture(atlas.texture);
+    sprite.setTextureRect(rect);
+    sprite.setScale(width / rect.width, height / rect.height);
     return true;
 }
-void setupSprite(Sprite& sprite, Texture& texture, float scaleX = 1.0f, float scaleY = 1.0f)
-{
-    sprite.setTexture(texture);
-    sprite.setScale(
-        (CELL_SIZE * scaleX) / texture.getSize().x,
-        (CELL_SIZE * scaleY) / texture.getSize().y);
-}
 // Main Function
-int main()
+int main(int argc, char* argv[])
 {
-    srand(static_cast<unsigned int>(time(0))); // Random Number Generator Setup
-    // Window Setup
-    const int windowWidth = COLS * CELL_SIZE + MARGIN * 2 + 500;
-    const int windowHeight = ROWS * CELL_SIZE + MARGIN * 2;
-    RenderWindow window(VideoMode(windowWidth, windowHeight), "Space Shooter");
-    window.setFramerateLimit(60);
-    // Save File Handling
-    int highScore = 0;
-    int savedLives = 0;
-    int savedScore = 0;
-    int savedLevel = 0;
-    bool hasSavedGame = false;
-    char saveFile[] = "save-file.txt";
-    ifstream inputFile(saveFile);
-    if (inputFile.is_open()) // Check if file exists
+    Clock startupClock; // --startup-report timings
+    Clock phaseClock;
+    // Command line options
+    bool showDrawStats = false; // --draw-stats: print draw calls per frame once a second
+    bool showVoiceStats = false; // --voice-stats: print what happened to sound requests once a second
+    bool showLatency = false; // --latency-report: print key press to display times on exit
+    bool startupReport = false; // --startup-report: print how long each asset and startup phase took
+    bool usePcmCache = true;    // --no-pcm-cache: decode the MP3s every launch and stream the music from MP3
+    long long boardRows = DEFAULT_ROWS; // --rows N / --cols N: board size (large boards are for load testing)
+    long long boardCols = DEFAULT_COLS;
+    int fpsLimit = -1; // --fps N: cap the frame rate at N instead of following vsync (0 = uncapped)
+    int hitEffectCapacity = 0; // --hit-effects N: hit effects live at once (0 = scaled with the board)
+    // --threads N: threads for the movement passes on big boards (1 .. MAX_BANDS, more would have no band to run)
+    int simThreads = min(max(static_cast<int>(thread::hardware_concurrency()), 1), MAX_BANDS);
+    const char* recordPath = nullptr; // --record FILE: write the inputs of the last game played to FILE
+    const char* replayPath = nullptr; // --replay FILE: play a recorded game back instead of taking input
+    long long seekTick = 0;           // --seek TICK: start the replay at TICK
+    int keyframeInterval = DEFAULT_KEYFRAME_INTERVAL; // --keyframe-interval N: ticks between recorded keyframes
+    const char* tracePath = nullptr;  // --trace FILE: write every profiled phase of the session as a Chrome trace
+    for (int i = 1; i < argc; i++)
     {
-        inputFile >> highScore >> savedLives >> savedScore >> savedLevel;
-        inputFile.close();
-        if (savedLevel > 0 && savedLives > 0) // Check if saved game exists
+        if (strcmp(argv[i], "--draw-stats") == 0)
         {
-            hasSavedGame = true;
+            showDrawStats = true;
         }
-    }
-    else // Create new save file with default data
-    {
-        ofstream createFile(saveFile);
-        if (createFile.is_open())
+        else if (strcmp(argv[i], "--voice-stats") == 0)
+        {
+            showVoiceStats = true;
+        }
+        else if (strcmp(argv[i], "--latency-report") == 0)
+        {
+            showLatency = true;
+        }
+        else if (strcmp(argv[i], "--startup-report") == 0)
+        {
+            startupReport = true;
+        }
+        else if (strcmp(argv[i], "--no-pcm-cache") == 0)
+        {
+            usePcmCache = false;
+        }
+        else if (strcmp(argv[i], "--rows") == 0 && i + 1 < argc)
+        {
+            boardRows = atoll(argv[++i]);
+        }
+        else if (strcmp(argv[i], "--cols") == 0 && i + 1 < argc)
+        {
+            boardCols = atoll(argv[++i]);
+        }
+        else if (strcmp(argv[i], "--fps") == 0 && i + 1 < argc)
+        {
+            fpsLimit = max(0, atoi(argv[++i]));
+        }
+        else if (strcmp(argv[i], "--hit-effects") == 0 && i + 1 < argc)
+        {
+            hitEffectCapacity = atoi(argv[++i]);
+        }
+        else if (strcmp(argv[i], "--threads") == 0 && i + 1 < argc)
+        {
+            simThreads = atoi(argv[++i]);
+            if (simThreads < 1 || simThreads > MAX_BANDS)
+            {
+                cerr << "--threads must be 1 to " << MAX_BANDS << endl;
+                return -1;
+            }
+        }
+        else if (strcmp(argv[i], "--record") == 0 && i + 1 < argc)
+        {
+            recordPath = argv[++i];
+        }
+        else if (strcmp(argv[i], "--replay") == 0 && i + 1 < argc)
+        {
+            replayPath = argv[++i];
+        }
+        else if (strcmp(argv[i], "--seek") == 0 && i + 1 < argc)
         {
-            createFile << "0 0 0 0";
-            createFile.close();
+            seekTick = atoll(argv[++i]);
+        }
+        else if (strcmp(argv[i], "--keyframe-interval") == 0 && i + 1 < argc)
+        {
+            keyframeInterval = atoi(argv[++i]);
+        }
+        else if (strcmp(argv[i], "--trace") == 0 && i + 1 < argc)
+        {
+            tracePath = argv[++i];
         }
     }
+    // Replays bring their own board size
+    Replay replay;
+    bool replaying = false;
+    long long replayTick = 0;
+    if (replayPath != nullptr)
+    {
+        if (!loadReplay(replay, replayPath)) return -1;
+        boardRows = replay.rows;
+        boardCols = replay.cols;
+        replaying = true;
+    }
+    if (!validBoardSize(boardRows, boardCols))
+    {
+        cerr << "Board must be at least " << MIN_ROWS << " rows by 1 column and at most " << MAX_BOARD_CELLS
+             << " cells" << endl;
+        return -1;
+    }
+    // Board on screen: full size cells, scaled down when the board is bigger than MAX_BOARD_WIDTH x MAX_BOARD_HEIGHT
+    float boardScale = 1.0f;
+    if (boardCols * CELL_SIZE * boardScale > MAX_BOARD_WIDTH)
+        boardScale = (float)MAX_BOARD_WIDTH / (boardCols * CELL_SIZE);
+    if (boardRows * CELL_SIZE * boardScale > MAX_BOARD_HEIGHT)
+        boardScale = (float)MAX_BOARD_HEIGHT / (boardRows * CELL_SIZE);
+    const int boardWidth = (int)(boardCols * CELL_SIZE * boardScale);
+    const int boardHeight = (int)(boardRows * CELL_SIZE * boardScale);
+    // Window Setup (never shorter than the normal board, the menus need the room)
+    const int windowWidth = boardWidth + MARGIN * 2 + 500;
+    const int windowHeight = max(boardHeight, DEFAULT_ROWS * CELL_SIZE) + MARGIN * 2;
+    phaseClock.restart();
+    RenderWindow window(VideoMode(windowWidth, windowHeight), "Space Shooter");
+    if (fpsLimit > 0)
+    {
+        window.setFramerateLimit(fpsLimit);
+    }
+    else if (fpsLimit < 0) // frames come as fast as the display shows them (board motion is interpolated)
+    {
+        window.setVerticalSyncEnabled(true);
+    }
+    float windowSeconds = phaseClock.restart().asSeconds();
+    // Save File Handling
+    int highScore = loadHighScore();
+    scanSaveSlots(); // the only time the slot files are read to see which hold a game
+    bool hasSavedGame = anySavedGame();
+    bool slotMenuSaving = false; // slot menu saves (true) or loads (false)
+    int activeSlot = -1;         // slot the current game was loaded from or saved to
     // Game Variables
     int currentState = STATE_MENU;
     int selectedMenuItem = 0;
-    int lives = 3;
-    int score = 0;
-    int killCount = 0;
-    int level = 1;
-    const int MAX_LEVEL = 5;
-    bool isInvincible = false;
-    Clock invincibilityTimer;
-    const float INVINCIBILITY_DURATION = 2.0f;
     Clock levelUpTimer;
     bool levelUpBlinkState = true;
     Clock levelUpBlinkClock;
-    int bossMoveCounter = 0;
-    // Grid System: 0=Empty, 1=Player, 2=Meteor, 3=Bullet, 4=Enemy, 5=Boss, 6=Boss Bullet
-    int grid[ROWS][COLS] = {0};
-    // Shield Powerup System
-    const int MAX_SHIELD_POWERUPS = 5;
-    int shieldPowerupRow[MAX_SHIELD_POWERUPS] = {-1, -1, -1, -1, -1};
-    int shieldPowerupCol[MAX_SHIELD_POWERUPS] = {-1, -1, -1, -1, -1};
-    bool shieldPowerupActive[MAX_SHIELD_POWERUPS] = {false, false, false, false, false};
-    int shieldPowerupDirection[MAX_SHIELD_POWERUPS] = {0, 0, 0, 0, 0};
-    bool hasShield = false;
-    // Hit Effect System
-    const int MAX_HIT_EFFECTS = 50;
-    int hitEffectRow[MAX_HIT_EFFECTS] = {0};
-    int hitEffectCol[MAX_HIT_EFFECTS] = {0};
-    float hitEffectTimer[MAX_HIT_EFFECTS] = {0.0f};
-    bool hitEffectActive[MAX_HIT_EFFECTS] = {false};
-    const float HIT_EFFECT_DURATION = 0.3f;
-    // Spaceship Initialization: Set up player's spaceship at starting position
-    int spaceshipCol = COLS / 2;
-    grid[ROWS - 1][spaceshipCol] = 1;
-    // Textures and Sprites Setup
-    Texture spaceshipTexture;
-    if (!loadTexture(spaceshipTexture, "assets/images/player.png")) return -1;
-    Sprite spaceship;
-    setupSprite(spaceship, spaceshipTexture);
-    Texture lifeTexture;
-    if (!loadTexture(lifeTexture, "assets/images/life.png")) return -1;
-    Sprite lifeIcon;
-    lifeIcon.setTexture(lifeTexture);
-    lifeIcon.setScale(24.0f / lifeTexture.getSize().x, 24.0f / lifeTexture.getSize().y);
-    Texture shieldTexture, shieldPowerUpTexture;
-    if (!loadTexture(shieldTexture, "assets/images/shield.png")) return -1;
-    if (!loadTexture(shieldPowerUpTexture, "assets/images/shield-powerup.png")) return -1;
-    Sprite shieldIcon, shieldPowerUp;
-    setupSprite(shieldPowerUp, shieldPowerUpTexture);
-    setupSprite(shieldIcon, shieldTexture, 1.3f, 1.3f);
-    Texture bgTexture;
-    if (!loadTexture(bgTexture, "assets/images/backgroundColor.png")) return -1;
-    Sprite background;
-    background.setTexture(bgTexture);
-    background.setScale(
-        static_cast<float>(COLS * CELL_SIZE) / bgTexture.getSize().x,
-        static_cast<float>(ROWS * CELL_SIZE) / bgTexture.getSize().y);
-    background.setPosition(MARGIN, MARGIN);
-    RectangleShape gameBox(Vector2f(COLS * CELL_SIZE, ROWS * CELL_SIZE));
+    // Gameplay state (grid, lives, score, level, powerups, effects and timers)
+    setSimulationThreads(simThreads);
+    GameState game;
+    setupBoard(game, boardRows, boardCols);
+    if (hitEffectCapacity > 0)
+    {
+        setHitEffectCapacity(game, hitEffectCapacity);
+    }
+    if (migrateOldSave(game, newSeed()))
+    {
+        highScore = loadHighScore();
+        hasSavedGame = anySavedGame();
+    }
+    newGame(game, 3, 0, 1);
+    // Every game played is recorded (seed + input per tick), and written out with --record
+    Replay recording;
+    bool restartPending = false; // restart from the pause menu, goes into the next recorded tick
+    // Asset Pack: every asset is read straight out of one mapped file (next to the executable), which stays
+    // mapped for the whole run because the font and the music keep reading from it
+    phaseClock.restart();
+    AssetPack pack;
+    string packPath = findPackPath(argv[0]);
+    if (!openPack(pack, packPath.c_str())) return -1;
+    float packSeconds = phaseClock.restart().asSeconds();
+    const void* assetData;
+    size_t assetSize;
+    // Font Setup for text (first, the loading screen needs it)
+    Font font;
+    if (!findPackFile(pack, "fonts/font.ttf", assetData, assetSize) || !font.loadFromMemory(assetData, assetSize))
+    {
+        cerr << "Failed to load font" << endl;
+        return -1;
+    }
+    float fontSeconds = phaseClock.restart().asSeconds();
+    // Asset Loading: images and sounds are decoded on worker threads while a progress bar is shown
+    vector<string> imagePaths = listPackFiles(pack, "images/", ".png");
+    AssetLoader loader;
+    for (size_t i = 0; i < imagePaths.size(); i++)
+    {
+        if (!findPackFile(pack, imagePaths[i].c_str(), assetData, assetSize)) return -1;
+        addImage(loader, imagePaths[i], assetData, assetSize);
+    }
+    const char soundFiles[SOUND_COUNT][40] = {"sounds/shoot.wav", "sounds/explosion.wav", "sounds/damage.mp3",
+                                              "sounds/level-up.mp3", "sounds/menu-click.mp3",
+                                              "sounds/menu-navigate.wav", "sounds/win.wav", "sounds/lose.wav"};
+    for (int i = 0; i < SOUND_COUNT; i++)
+    {
+        if (!findPackFile(pack, soundFiles[i], assetData, assetSize)) return -1;
+        addSound(loader, soundFiles[i], assetData, assetSize);
+    }
+    int musicSound = -1; // with the cache the music is decoded once like the effects, then streamed from memory
+    if (usePcmCache)
+    {
+        if (!findPackFile(pack, "sounds/bg-music.mp3", assetData, assetSize)) return -1;
+        musicSound = addSound(loader, "sounds/bg-music.mp3", assetData, assetSize);
+        loader.pcmCacheFolder = pcmCacheFolder(packPath);
+    }
+    int loaderThreads = max(1, (int)thread::hardware_concurrency());
+    startAssetLoader(loader, loaderThreads);
+    Text loadingText("Loading...", font, 28);
+    loadingText.setFillColor(Color::Yellow);
+    loadingText.setPosition(windowWidth / 2 - loadingText.getLocalBounds().width / 2.0f, windowHeight / 2 - 60);
+    RectangleShape loadingBox(Vector2f(400, 24));
+    loadingBox.setFillColor(Color::Transparent);
+    loadingBox.setOutlineThickness(2);
+    loadingBox.setOutlineColor(Color::White);
+    loadingBox.setPosition(windowWidth / 2 - 200, windowHeight / 2);
+    RectangleShape loadingBar;
+    loadingBar.setFillColor(Color::Yellow);
+    loadingBar.setPosition(windowWidth / 2 - 200, windowHeight / 2);
+    int jobCount = static_cast<int>(loader.jobs.size());
+    while (assetsDone(loader) < jobCount && window.isOpen())
+    {
+        Event event;
+        while (window.pollEvent(event))
+        {
+            if (event.type == Event::Closed)
+                window.close();
+        }
+        loadingBar.setSize(Vector2f(400.0f * assetsDone(loader) / jobCount, 24));
+        window.clear(Color(40, 40, 40));
+        window.draw(loadingText);
+        window.draw(loadingBox);
+        window.draw(loadingBar);
+        window.display();
+    }
+    if (!finishAssetLoader(loader)) return -1;
+    if (!window.isOpen()) return 0; // closed while loading
+    float decodeSeconds = phaseClock.restart().asSeconds();
+    // Textures and Sprites Setup: all images share one atlas texture
+    TextureAtlas atlas;
+    if (!buildAtlas(atlas, imagePaths, loader.images)) return -1;
+    float atlasSeconds = phaseClock.restart().asSeconds();
+    Sprite spaceship, lifeIcon, shieldPowerUp, background, meteor, enemy, bossEnemy, bullet, bossBullet, menuBackground;
+    if (!setupSprite(spaceship, atlas, "player.png", CELL_SIZE, CELL_SIZE) ||
+        !setupSprite(lifeIcon, atlas, "life.png", 24.0f, 24.0f) ||
+        !setupSprite(shieldPowerUp, atlas, "shield-powerup.png", CELL_SIZE, CELL_SIZE) ||
+        !setupSprite(background, atlas, "backgroundColor.png", boardCols * CELL_SIZE, boardRows * CELL_SIZE) ||
+        !setupSprite(meteor, atlas, "meteorSmall.png", CELL_SIZE, CELL_SIZE) ||
+        !setupSprite(enemy, atlas, "enemyUFO.png", CELL_SIZE, CELL_SIZE) ||
+        !setupSprite(bossEnemy, atlas, "enemyShip.png", CELL_SIZE, CELL_SIZE) ||
+        !setupSprite(bullet, atlas, "laserRed.png", CELL_SIZE * 0.3f, CELL_SIZE * 0.8f) ||
+        !setupSprite(bossBullet, atlas, "laserGreen.png", CELL_SIZE * 0.3f, CELL_SIZE * 0.8f) ||
+        !setupSprite(menuBackground, atlas, "starBackground.png", windowWidth, windowHeight))
+    {
+        return -1;
+    }
+    background.setPosition(0, 0); // board space, drawn through boardView
+    menuBackground.setPosition(0, 0);
+    // The board is drawn in board space (CELL_SIZE per cell) and this view fits it into its place in the window
+    View boardView(FloatRect(0, 0, boardCols * CELL_SIZE, boardRows * CELL_SIZE));
+    boardView.setViewport(FloatRect((float)MARGIN / windowWidth, (float)MARGIN / windowHeight,
+                                    (float)boardWidth / windowWidth, (float)boardHeight / windowHeight));
+    RectangleShape gameBox(Vector2f(boardWidth, boardHeight));
     gameBox.setFillColor(Color::Transparent);
     gameBox.setOutlineThickness(5);
     gameBox.setOutlineColor(Color::Black);
     gameBox.setPosition(MARGIN, MARGIN);
-    Texture meteorTexture;
-    if (!loadTexture(meteorTexture, "assets/images/meteorSmall.png")) return -1;
-    Sprite meteor;
-    setupSprite(meteor, meteorTexture);
-    Texture enemyTexture, bossEnemyTexture;
-    if (!loadTexture(enemyTexture, "assets/images/enemyUFO.png")) return -1;
-    if (!loadTexture(bossEnemyTexture, "assets/images/enemyShip.png")) return -1;
-    Sprite enemy, bossEnemy;
-    setupSprite(enemy, enemyTexture);
-    setupSprite(bossEnemy, bossEnemyTexture);
-    Texture bulletTexture, bulletHitTexture, bossBulletTexture, bossBulletHitTexture;
-    if (!loadTexture(bulletTexture, "assets/images/laserRed.png")) return -1;
-    if (!loadTexture(bulletHitTexture, "assets/images/laserRedShot.png")) return -1;
-    if (!loadTexture(bossBulletTexture, "assets/images/laserGreen.png")) return -1;
-    if (!loadTexture(bossBulletHitTexture, "assets/images/laserGreenShot.png")) return -1;
-    Sprite bullet, bulletHit, bossBullet, bossBulletHit;
-    setupSprite(bullet, bulletTexture, 0.3f, 0.8f);
-    setupSprite(bulletHit, bulletHitTexture);
-    setupSprite(bossBullet, bossBulletTexture, 0.3f, 0.8f);
-    setupSprite(bossBulletHit, bossBulletHitTexture);
-    Texture menuBgTexture;
-    if (!loadTexture(menuBgTexture, "assets/images/starBackground.png")) return -1;
-    Sprite menuBackground;
-    menuBackground.setTexture(menuBgTexture);
-    menuBackground.setScale(
-        static_cast<float>(windowWidth) / menuBgTexture.getSize().x,
-        static_cast<float>(windowHeight) / menuBgTexture.getSize().y);
-    menuBackground.setPosition(0, 0);
-    // Font Setup for text
-    Font font;
-    if (!font.loadFromFile("assets/fonts/font.ttf"))
+    // Board batch: each board sprite is a rectangle of the atlas (indexed by SPRITE_*, grid code - 1 for 1-6)
+    BoardBatch boardBatch;
+    setupBatch(boardBatch, atlas.texture);
+    const char boardImages[SPRITE_COUNT][24] = {"player.png", "meteorSmall.png", "laserRed.png", "enemyUFO.png", "enemyShip.png",
+                                                "laserGreen.png", "shield-powerup.png", "laserRedShot.png", "shield.png"};
+    const float boardScaleX[SPRITE_COUNT] = {1.0f, 1.0f, 0.3f, 1.0f, 1.0f, 0.3f, 1.0f, 1.0f, 1.3f};
+    const float boardScaleY[SPRITE_COUNT] = {1.0f, 1.0f, 0.8f, 1.0f, 1.0f, 0.8f, 1.0f, 1.0f, 1.3f};
+    for (int i = 0; i < SPRITE_COUNT; i++)
     {
-        cerr << "Failed to load font" << endl;
-        return -1;
+        IntRect rect;
+        if (!findAtlasRect(atlas, boardImages[i], rect)) return -1;
+        setupFrame(boardBatch, i, rect, boardScaleX[i], boardScaleY[i], i == SPRITE_SHIELD ? SHIELD_OFFSET : 0.0f);
     }
+    // Explosion debris: every explosion the ticks report throws some out, drawn in the board batch
+    ParticleSystem particles;
+    setupParticles(particles, MAX_PARTICLES);
+    RenderStats renderStats = {0, 0, 0};
+    Clock drawStatsClock;
+    Clock voiceStatsClock;
     // Music and Sound Effects Setup
-    Music bgMusic;
-    if (!bgMusic.openFromFile("assets/sounds/bg-music.mp3"))
+    phaseClock.restart();
+    PcmStream cachedMusic;
+    Music mp3Music;
+    SoundStream& bgMusic = usePcmCache ? static_cast<SoundStream&>(cachedMusic) : static_cast<SoundStream&>(mp3Music);
+    if (usePcmCache)
+    {
+        cachedMusic.open(loader.sounds[musicSound]);
+    }
+    else if (!findPackFile(pack, "sounds/bg-music.mp3", assetData, assetSize) ||
+             !mp3Music.openFromMemory(assetData, assetSize))
     {
         cerr << "Failed to load background music" << endl;
         return -1;
     }
+    float musicSeconds = phaseClock.restart().asSeconds();
     bgMusic.setLoop(true);  // Music never ends
     bgMusic.setVolume(30);  // low volume
-    bgMusic.play();         // start playing as game starts
-    SoundBuffer shootBuffer, explosionBuffer, damageBuffer, levelUpBuffer;
-    SoundBuffer menuClickBuffer, menuNavBuffer, winBuffer, loseBuffer;
-    if (!shootBuffer.loadFromFile("assets/sounds/shoot.wav") ||
-        !explosionBuffer.loadFromFile("assets/sounds/explosion.wav") ||
-        !damageBuffer.loadFromFile("assets/sounds/damage.mp3") ||
-        !levelUpBuffer.loadFromFile("assets/sounds/level-up.mp3") ||
-        !menuClickBuffer.loadFromFile("assets/sounds/menu-click.mp3") ||
-        !menuNavBuffer.loadFromFile("assets/sounds/menu-navigate.wav") ||
-        !winBuffer.loadFromFile("assets/sounds/win.wav") ||
-        !loseBuffer.loadFromFile("assets/sounds/lose.wav"))
+    if (replaying) // straight into the recorded game
     {
-        cerr << "Failed to load sound files" << endl;
-        return -1;
+        if (!seekReplay(replay, game, seekTick))
+        {
+            cerr << "Cannot seek to tick " << seekTick << " of the replay" << endl;
+            return -1;
+        }
+        replayTick = seekTick;
+        currentState = STATE_PLAYING;
+    }
+    else
+    {
+        bgMusic.play();         // start playing as game starts
+    }
+    SoundBuffer soundBuffers[SOUND_COUNT];
+    // already decoded, in soundFiles order (the SOUND_* effect order)
+    phaseClock.restart();
+    for (int i = 0; i < SOUND_COUNT; i++)
+    {
+        if (!finishSound(loader.sounds[i], soundBuffers[i]))
+        {
+            cerr << "Failed to load sound files" << endl;
+            return -1;
+        }
+    }
+    float soundSeconds = phaseClock.restart().asSeconds();
+    if (startupReport)
+    {
+        cout << "Startup report (ms):" << endl;
+        for (size_t i = 0; i < loader.jobs.size(); i++)
+        {
+            bool cached = loader.jobs[i].kind == ASSET_SOUND && loader.sounds[loader.jobs[i].index].fromCache;
+            cout << "  decode " << loader.jobs[i].name << ": " << loader.jobs[i].seconds * 1000.0f
+                 << (cached ? " (from PCM cache)" : "") << endl;
+        }
+        cout << "  window: " << windowSeconds * 1000.0f << endl;
+        cout << "  pack open: " << packSeconds * 1000.0f << endl;
+        cout << "  font: " << fontSeconds * 1000.0f << endl;
+        cout << "  decode (" << loaderThreads << " threads, wall): " << decodeSeconds * 1000.0f << endl;
+        cout << "  atlas upload: " << atlasSeconds * 1000.0f << endl;
+        cout << "  music open: " << musicSeconds * 1000.0f << endl;
+        cout << "  sound upload: " << soundSeconds * 1000.0f << endl;
+        cout << "  total: " << startupClock.getElapsedTime().asSeconds() * 1000.0f << endl;
     }
-    Sound shootSound, explosionSound, damageSound, levelUpSound;
-    Sound menuClickSound, menuNavSound, winSound, loseSound;
-    shootSound.setBuffer(shootBuffer);
-    explosionSound.setBuffer(explosionBuffer);
-    damageSound.setBuffer(damageBuffer);
-    levelUpSound.setBuffer(levelUpBuffer);
-    menuClickSound.setBuffer(menuClickBuffer);
-    menuNavSound.setBuffer(menuNavBuffer);
-    winSound.setBuffer(winBuffer);
-    loseSound.setBuffer(loseBuffer);
+    VoicePool voices;
+    setupVoices(voices, soundBuffers);
     // Text Setup throughout the game
     Text menuTitle("SPACE SHOOTER", font, 40);
     menuTitle.setFillColor(Color::Yellow); 
@@ -323,38 +532,38 @@ int main()
         menuItems[i].setFillColor(Color::White);
         menuItems[i].setPosition(windowWidth / 2 - menuItems[i].getLocalBounds().width / 2.0f, 260 + i * 56); // Centered
     }
-    Text menuHighScoreText("High Score: 0", font, 24);  // Placeholder text (0)
-    menuHighScoreText.setFillColor(Color::Yellow);
-    menuHighScoreText.setPosition(windowWidth / 2 - menuHighScoreText.getLocalBounds().width / 2.0f, 180); // Centered
+    NumberText menuHighScoreText;
+    setupNumberText(menuHighScoreText, font, 24, Color::Yellow, "High Score: %d", windowWidth / 2, 180, true); // Centered
     Text menuInstructions("Use UP/DOWN or W/S to navigate  |  ENTER to select", font, 18);
     menuInstructions.setFillColor(Color(150, 150, 150));
     menuInstructions.setPosition(windowWidth / 2 - menuInstructions.getLocalBounds().width / 2.0f, windowHeight - 80); // Centered
     // Playing state text
     Text title("Space  Shooter", font, 28);
     title.setFillColor(Color::Yellow);
-    title.setPosition(MARGIN + COLS * CELL_SIZE + 20, MARGIN);
+    title.setPosition(MARGIN + boardWidth + 20, MARGIN);
     Text livesText("Lives:", font, 20);
     livesText.setFillColor(Color::White);
-    livesText.setPosition(MARGIN + COLS * CELL_SIZE + 20, MARGIN + 150);
-    Text scoreText("Score: 0", font, 20);
-    scoreText.setFillColor(Color::White);
-    scoreText.setPosition(MARGIN + COLS * CELL_SIZE + 20, MARGIN + 200);
-    Text killsText("Kills: 0/10", font, 20);
-    killsText.setFillColor(Color::White);
-    killsText.setPosition(MARGIN + COLS * CELL_SIZE + 20, MARGIN + 230);
-    Text levelText("Level: 1", font, 20);
-    levelText.setFillColor(Color::White);
-    levelText.setPosition(MARGIN + COLS * CELL_SIZE + 20, MARGIN + 280);
-    Text highScoreText("High Score: 0", font, 20);
-    highScoreText.setFillColor(Color::Yellow);
-    highScoreText.setPosition(MARGIN + COLS * CELL_SIZE + 20, MARGIN + 330);
+    livesText.setPosition(MARGIN + boardWidth + 20, MARGIN + 150);
+    // Icons for the lives left go after the label
+    float lifeIconStartX = livesText.getPosition().x + livesText.getLocalBounds().width + 10;
+    float lifeIconY = livesText.getPosition().y + (livesText.getLocalBounds().height / 2.0f) - 12;
+    // Numbers on the side panel, rebuilt only when they change
+    NumberText scoreText, killsText, levelText, highScoreText;
+    setupNumberText(scoreText, font, 20, Color::White, "Score: %d", MARGIN + boardWidth + 20, MARGIN + 200, false);
+    setupNumberText(killsText, font, 20, Color::White, "Kills: %d/%d", MARGIN + boardWidth + 20, MARGIN + 230, false);
+    setupNumberText(levelText, font, 20, Color::White, "Level: %d", MARGIN + boardWidth + 20, MARGIN + 280, false);
+    setupNumberText(highScoreText, font, 20, Color::Yellow, "High Score: %d", MARGIN + boardWidth + 20, MARGIN + 330, false);
+    Text quickSaveText("", font, 20); // F5 confirmation, shown for a moment
+    quickSaveText.setFillColor(Color::Green);
+    quickSaveText.setPosition(MARGIN + boardWidth + 20, MARGIN + 380);
+    Clock quickSaveClock;
+    bool showQuickSave = false;
     // Game Over Screen
     Text gameOverTitle("GAME OVER", font, 40);
     gameOverTitle.setFillColor(Color::Red);
     gameOverTitle.setPosition(windowWidth / 2 - gameOverTitle.getLocalBounds().width / 2.0f, 100);
-    Text gameOverScore("Final Score: 0", font, 28);
-    gameOverScore.setFillColor(Color::Yellow);
-    gameOverScore.setPosition(windowWidth / 2 - gameOverScore.getLocalBounds().width / 2.0f, 200);
+    NumberText gameOverScore;
+    setupNumberText(gameOverScore, font, 28, Color::Yellow, "Final Score: %d", windowWidth / 2, 200, true);
     Text gameOverItems[2];
     const char gameOverTexts[2][20] = {"Restart", "Main Menu"};
     for (int i = 0; i < 2; i++)
@@ -371,8 +580,8 @@ int main()
     // Level Up Screen
     Text levelUpText("LEVEL UP!", font, 40);
     levelUpText.setFillColor(Color::Green);
-    float gridCenterX = MARGIN + (COLS * CELL_SIZE) / 2.0f;
-    float gridCenterY = MARGIN + (ROWS * CELL_SIZE) / 2.0f;
+    float gridCenterX = MARGIN + boardWidth / 2.0f;
+    float gridCenterY = MARGIN + boardHeight / 2.0f;
     levelUpText.setPosition(gridCenterX - levelUpText.getLocalBounds().width / 2.0f, gridCenterY - levelUpText.getLocalBounds().height / 2.0f - 10);
     // Pause Screen
     Text pauseTitle("PAUSED", font, 40);
@@ -388,13 +597,22 @@ int main()
         pauseItems[i].setFillColor(Color::White);
         pauseItems[i].setPosition(gridCenterX - pauseItems[i].getLocalBounds().width / 2.0f, gridCenterY - 50 + i * 56);
     }
+    // Save Slot Screen
+    Text slotTitle("LOAD GAME", font, 40);
+    slotTitle.setFillColor(Color::Yellow);
+    Text slotItems[SAVE_SLOTS + 1];
+    for (int i = 0; i <= SAVE_SLOTS; i++)
+    {
+        slotItems[i].setFont(font);
+        slotItems[i].setCharacterSize(28);
+        slotItems[i].setFillColor(Color::White);
+    }
     // Victory Screen
     Text victoryTitle("VICTORY!", font, 40);
     victoryTitle.setFillColor(Color::Yellow);
     victoryTitle.setPosition(windowWidth / 2 - victoryTitle.getLocalBounds().width / 2.0f, 100);
-    Text victoryScore("Final Score: 0", font, 28);
-    victoryScore.setFillColor(Color::White);
-    victoryScore.setPosition(windowWidth / 2 - victoryScore.getLocalBounds().width / 2.0f, 200);
+    NumberText victoryScore;
+    setupNumberText(victoryScore, font, 28, Color::White, "Final Score: %d", windowWidth / 2, 200, true);
     Text victoryItems[2];
     const char victoryTexts[2][20] = {"Restart", "Main Menu"};
     for (int i = 0; i < 2; i++)
@@ -421,7 +639,7 @@ int main()
     Text shootText("Shoot: SPACEBAR", font, 18);
     shootText.setFillColor(Color::White);
     shootText.setPosition(50, 170);
-    Text pauseText("Pause: P", font, 18);
+    Text pauseText("Pause: P  |  Quick Save: F5", font, 18);
     pauseText.setFillColor(Color::White);
     pauseText.setPosition(50, 200);
     Text entitiesTitle("ENTITIES", font, 24);
@@ -479,111 +697,134 @@ int main()
     Text instructionsBack("Press ESC or BACKSPACE to return to menu", font, 18);
     instructionsBack.setFillColor(Color(150, 150, 150));
     instructionsBack.setPosition(windowWidth / 2 - instructionsBack.getLocalBounds().width / 2.0f, windowHeight - 80);
-    // All the clocks and cooldowns controlling the time of events in the game
-    // Movement Delay to avoid fast movement when key is held
-    Clock moveClock;
-    Time moveCooldown = milliseconds(100);
-    // After what time will a new meteor spawn
-    Clock meteorSpawnClock;
-    Clock meteorMoveClock;
-    float nextSpawnTime = 1.0f + (rand() % 3);
-    // After what time will a new enemy spawn
-    Clock enemySpawnClock;
-    Clock enemyMoveClock;
-    float nextEnemySpawnTime = 2.0f + (rand() % 4);
-    // After what time will a new boss spawn (level 3+)
-    Clock bossSpawnClock;
-    Clock bossMoveClock;
-    Clock bossBulletMoveClock;
-    float nextBossSpawnTime = 8.0f + (rand() % 5);
-    // After what time will a new shield powerup spawn (level 3+)
-    Clock shieldPowerupSpawnClock;
-    Clock shieldPowerupMoveClock;
-    float nextShieldPowerupSpawnTime = 15.0f + (rand() % 10);
-    // Bullet firing delay and bullet speed
-    Clock bulletMoveClock;
-    Clock bulletFireClock;
-    Time bulletFireCooldown = milliseconds(300);
-    // How long to show explosion effects
-    Clock hitEffectClock;
-    // same delay as movement for menu navigation to avoid fast input
-    Clock menuClock;
-    Time menuCooldown = milliseconds(200);
+    // Real time since the last frame, spent in fixed simulation ticks
+    Clock frameClock;
+    float tickAccumulator = 0.0f;
+    float drawnSinceTick = 0.0f; // what the last playing frame drew with, so pausing holds that picture
+    int vsyncCheckFrames = fpsLimit < 0 ? 0 : VSYNC_CHECK_FRAMES; // nothing to check with --fps
+    float vsyncCheckTime = 0.0f;
+    // Input comes from the window's event queue: key presses for the screens, in order, and the player
+    // controls into a buffer the ticks take their input from, so no press is missed between two frames
+    deque<Keyboard::Key> keyPresses;
+    InputBuffer playerInput;
+    resetInput(playerInput);
+    Clock inputClock;
+    // Press to display times (--latency-report). SFML has no hardware timestamps, so a press is timed from
+    // when pollEvent handed it over, not from the key going down.
+    LatencyTracker latency;
+    // Frame profiler: F3 shows per-phase times, --trace records them all
+    bool showProfiler = false;
+    RectangleShape profilerBox(Vector2f(330, PHASE_COUNT * 18 + 34));
+    profilerBox.setPosition(10, 10);
+    profilerBox.setFillColor(Color(0, 0, 0, 180));
+    Text profilerText("", font, 14);
+    profilerText.setFillColor(Color::White);
+    profilerText.setPosition(20, 16);
+    Clock profilerClock; // the overlay numbers change twice a second, not every frame
+#ifndef SPACE_SHOOTER_PROFILING
+    if (tracePath != nullptr)
+    {
+        cerr << "Built without SPACE_SHOOTER_PROFILING, --trace has nothing to record" << endl;
+        tracePath = nullptr;
+    }
+#endif
+    if (tracePath != nullptr && !startTrace(tracePath))
+    {
+        cerr << "Could not write the trace to " << tracePath << endl;
+        return -1;
+    }
     // The Game Statrs from here
     while (window.isOpen())
     {
-        // Check if the user closes the window or not
-        Event event;
-        while (window.pollEvent(event))
+        endProfileFrame(); // the frame that just ended goes into the overlay numbers and the trace
+        PROFILE_SCOPE(PHASE_FRAME);
         {
-            if (event.type == Event::Closed)
-                window.close();
+            PROFILE_SCOPE(PHASE_INPUT);
+            // Check if the user closes the window or not
+            Event event;
+            while (window.pollEvent(event))
+            {
+                if (event.type == Event::Closed)
+                    window.close();
+                else if (event.type == Event::LostFocus) // key releases go elsewhere now
+                    releaseAllInput(playerInput, inputClock.getElapsedTime().asSeconds());
+                else if (event.type == Event::KeyPressed && event.key.code == Keyboard::F3)
+                {
+                    showProfiler = !showProfiler;
+                    setProfiling(showProfiler || tracePath != nullptr);
+                    profilerText.setString("Profiling...");
+                    profilerClock.restart();
+                }
+                else if (event.type == Event::KeyPressed || event.type == Event::KeyReleased)
+                {
+                    bool down = event.type == Event::KeyPressed;
+                    if (down)
+                    {
+                        keyPresses.push_back(event.key.code);
+                    }
+                    int control = gameplayKey(event.key.code);
+                    if (control >= 0)
+                    {
+                        pushInput(playerInput, control, down, inputClock.getElapsedTime().asSeconds());
+                    }
+                }
+            }
+        }
+        float frameTime = frameClock.restart().asSeconds();
+        if (vsyncCheckFrames < VSYNC_CHECK_FRAMES)
+        {
+            vsyncCheckTime += frameTime;
+            vsyncCheckFrames++;
+            if (vsyncCheckFrames == VSYNC_CHECK_FRAMES && vsyncCheckTime < VSYNC_CHECK_FRAMES * MIN_VSYNC_FRAME_TIME)
+            {
+                window.setVerticalSyncEnabled(false);
+                window.setFramerateLimit(VSYNC_FALLBACK_FPS);
+            }
+        }
+        if (frameTime > MAX_FRAME_TIME)
+        {
+            frameTime = MAX_FRAME_TIME;
         }
         // C++ Logic for each Game Screen
         // Menu Screen
         if (currentState == STATE_MENU)
         {
-            if (menuClock.getElapsedTime() >= menuCooldown) // Condition for menu cooldown
+            Keyboard::Key key;
+            while (currentState == STATE_MENU && takeKey(keyPresses, key)) // presses in order, until the screen changes
             {
-                bool menuAction = false;
-                if (Keyboard::isKeyPressed(Keyboard::Up) || Keyboard::isKeyPressed(Keyboard::W))
+                if (key == Keyboard::Up || key == Keyboard::W)
                 {
                     selectedMenuItem = (selectedMenuItem - 1 + 4) % 4; // (+4 so that selected never becomes negative)
-                    menuNavSound.play();
-                    menuAction = true;
+                    playSound(voices, SOUND_MENU_NAV);
                 }
-                else if (Keyboard::isKeyPressed(Keyboard::Down) || Keyboard::isKeyPressed(Keyboard::S))
+                else if (key == Keyboard::Down || key == Keyboard::S)
                 {
                     selectedMenuItem = (selectedMenuItem + 1) % 4;
-                    menuNavSound.play();
-                    menuAction = true;
+                    playSound(voices, SOUND_MENU_NAV);
                 }
-                else if (Keyboard::isKeyPressed(Keyboard::Enter))
+                else if (key == Keyboard::Enter)
                 {
-                    menuClickSound.play();
+                    playSound(voices, SOUND_MENU_CLICK);
                     if (selectedMenuItem == 0) // (Start New Game)
                     {
                         bgMusic.stop();
                         currentState = STATE_PLAYING;
                         // Game Will start fresh
-                        lives = 3;
-                        score = 0;
-                        killCount = 0;
-                        level = 1;
-                        bossMoveCounter = 0;
-                        hasShield = false;
-                        clearGrid(grid);
-                        for (int i = 0; i < MAX_SHIELD_POWERUPS; i++)
-                        {
-                            shieldPowerupActive[i] = false;
-                        }
-                        resetSpaceship(grid, spaceshipCol);
-                        restartAllClocks(meteorSpawnClock, meteorMoveClock, enemySpawnClock, enemyMoveClock,
-                                        bossSpawnClock, bossMoveClock, bossBulletMoveClock, bulletMoveClock,
-                                        shieldPowerupSpawnClock, shieldPowerupMoveClock);
+                        startPlayerGame(game, recording, false, keyframeInterval, replaying, replayTick,
+                                        restartPending, particles);
+                        activeSlot = -1;
                     }
                     else if (selectedMenuItem == 1) // (Load Saved Game)
                     {
                         if (hasSavedGame)  // Will only work if there is a saved game
                         {
-                            bgMusic.stop();
-                            currentState = STATE_PLAYING;
-                            // Game will start with saved lives, score, and level
-                            lives = savedLives;
-                            score = savedScore;
-                            killCount = 0;
-                            level = savedLevel;
-                            bossMoveCounter = 0;
-                            hasShield = false;
-                            clearGrid(grid);
-                            for (int i = 0; i < MAX_SHIELD_POWERUPS; i++)
-                            {
-                                shieldPowerupActive[i] = false;
-                            }
-                            resetSpaceship(grid, spaceshipCol);
-                            restartAllClocks(meteorSpawnClock, meteorMoveClock, enemySpawnClock, enemyMoveClock,
-                                            bossSpawnClock, bossMoveClock, bossBulletMoveClock, bulletMoveClock,
-                                            shieldPowerupSpawnClock, shieldPowerupMoveClock);
+                            slotMenuSaving = false;
+                            slotTitle.setString("LOAD GAME");
+                            slotTitle.setPosition(windowWidth / 2 - slotTitle.getLocalBounds().width / 2.0f, 100);
+                            renderStats.textRebuilds++;
+                            updateSlotTexts(slotItems, windowWidth / 2.0f, renderStats);
+                            currentState = STATE_SAVE_SLOTS;
+                            selectedMenuItem = 0;
                         }
                         else
                         {
@@ -599,11 +840,6 @@ int main()
                         bgMusic.stop();
                         window.close();
                     }
-                    menuAction = true; // trigger the cooldown
-                }
-                if (menuAction)
-                {
-                    menuClock.restart(); // Restart cooldown
                 }
             }
 
@@ -612,58 +848,37 @@ int main()
         // Game Over Screen
         else if (currentState == STATE_GAME_OVER)
         {
-            if (menuClock.getElapsedTime() >= menuCooldown) // Same Cooldown logic for menu navigation
+            Keyboard::Key key;
+            while (currentState == STATE_GAME_OVER && takeKey(keyPresses, key))
             {
-                bool menuAction = false;
-                if (Keyboard::isKeyPressed(Keyboard::Up) || Keyboard::isKeyPressed(Keyboard::W))
+                if (key == Keyboard::Up || key == Keyboard::W)
                 {
                     selectedMenuItem = (selectedMenuItem - 1 + 2) % 2;
-                    menuNavSound.play();
-                    menuAction = true;
+                    playSound(voices, SOUND_MENU_NAV);
                 }
-                else if (Keyboard::isKeyPressed(Keyboard::Down) || Keyboard::isKeyPressed(Keyboard::S))
+                else if (key == Keyboard::Down || key == Keyboard::S)
                 {
                     selectedMenuItem = (selectedMenuItem + 1) % 2;
-                    menuNavSound.play();
-                    menuAction = true;
+                    playSound(voices, SOUND_MENU_NAV);
                 }
-                else if (Keyboard::isKeyPressed(Keyboard::Enter))
+                else if (key == Keyboard::Enter)
                 {
-                    menuClickSound.play();
+                    playSound(voices, SOUND_MENU_CLICK);
                     if (selectedMenuItem == 0) // (Restart Game)
                     {
                         currentState = STATE_PLAYING;
-                        lives = 3;
-                        score = 0;
-                        killCount = 0;
-                        level = 1;
-                        bossMoveCounter = 0;
-                        isInvincible = false;
-                        hasShield = false;
-                        clearGrid(grid);
-                        for (int i = 0; i < MAX_SHIELD_POWERUPS; i++)
-                        {
-                            shieldPowerupActive[i] = false;
-                        }
-                        resetSpaceship(grid, spaceshipCol);
-                        restartAllClocks(meteorSpawnClock, meteorMoveClock, enemySpawnClock, enemyMoveClock,
-                                        bossSpawnClock, bossMoveClock, bossBulletMoveClock, bulletMoveClock,
-                                        shieldPowerupSpawnClock, shieldPowerupMoveClock);
+                        startPlayerGame(game, recording, false, keyframeInterval, replaying, replayTick,
+                                        restartPending, particles);
                     }
                     else if (selectedMenuItem == 1) // (Return to Main Menu)
                     {
-                        if (bgMusic.getStatus() != Music::Playing)
+                        if (bgMusic.getStatus() != SoundSource::Playing)
                         {
                             bgMusic.play();
                         }
                         currentState = STATE_MENU;
                         selectedMenuItem = 0;
                     }
-                    menuAction = true;
-                }
-                if (menuAction) // Same menu cooldown logic
-                {
-                    menuClock.restart();
                 }
             }
             setMenuColors(gameOverItems, 2, selectedMenuItem);
@@ -671,635 +886,181 @@ int main()
         // Instructions Screen
         else if (currentState == STATE_INSTRUCTIONS)
         {
-            if (menuClock.getElapsedTime() >= menuCooldown)
+            Keyboard::Key key;
+            while (currentState == STATE_INSTRUCTIONS && takeKey(keyPresses, key))
             {
-                if (Keyboard::isKeyPressed(Keyboard::Escape) || Keyboard::isKeyPressed(Keyboard::BackSpace))
+                if (key == Keyboard::Escape || key == Keyboard::BackSpace)
                 {
-                    menuClickSound.play();
+                    playSound(voices, SOUND_MENU_CLICK);
                     currentState = STATE_MENU;
                     selectedMenuItem = 0;
-                    menuClock.restart();
                 }
             }
         }
-        // Playing Screen
-        else if (currentState == STATE_PLAYING)
+        // Save Slot Screen
+        else if (currentState == STATE_SAVE_SLOTS)
         {
-            if (menuClock.getElapsedTime() >= menuCooldown) // Constantly check for pause input
+            Keyboard::Key key;
+            while (currentState == STATE_SAVE_SLOTS && takeKey(keyPresses, key))
             {
-                if (Keyboard::isKeyPressed(Keyboard::P))
+                if (key == Keyboard::Up || key == Keyboard::W)
                 {
-                    currentState = STATE_PAUSED;
-                    selectedMenuItem = 0;
-                    menuClock.restart();
-                }
-            }
-            // Spaceshipe Movement left right
-            if (moveClock.getElapsedTime() >= moveCooldown)
-            {
-                bool moved = false;
-                if ((Keyboard::isKeyPressed(Keyboard::Left) || Keyboard::isKeyPressed(Keyboard::A)) && spaceshipCol > 0)
-                {
-                    grid[ROWS - 1][spaceshipCol] = 0; // Clear current position
-                    spaceshipCol--;                   // Move left
-                    grid[ROWS - 1][spaceshipCol] = 1; // Put Spaceship there
-                    moved = true; // trigger cooldown
+                    selectedMenuItem = (selectedMenuItem - 1 + SAVE_SLOTS + 1) % (SAVE_SLOTS + 1);
+                    playSound(voices, SOUND_MENU_NAV);
                 }
-                else if ((Keyboard::isKeyPressed(Keyboard::Right) || Keyboard::isKeyPressed(Keyboard::D)) && spaceshipCol < COLS - 1)
+                else if (key == Keyboard::Down || key == Keyboard::S)
                 {
-                    grid[ROWS - 1][spaceshipCol] = 0; // Clear current position
-                    spaceshipCol++;                    // Move right
-                    grid[ROWS - 1][spaceshipCol] = 1; // Put Spaceship there
-                    moved = true; // trigger cooldown
+                    selectedMenuItem = (selectedMenuItem + 1) % (SAVE_SLOTS + 1);
+                    playSound(voices, SOUND_MENU_NAV);
                 }
-                if (moved) // restart cooldown timer
+                else if (key == Keyboard::Enter)
                 {
-                    moveClock.restart();
-                }
-            }
-            // Bullet firing
-            if (Keyboard::isKeyPressed(Keyboard::Space) && bulletFireClock.getElapsedTime() >= bulletFireCooldown)
-            {
-                int bulletRow = ROWS - 2;  // Just above the spaceship
-                if (bulletRow >= 0 && grid[bulletRow][spaceshipCol] == 0)
-                {
-                    grid[bulletRow][spaceshipCol] = 3;
-                    shootSound.play();
-                }
-                bulletFireCooldown = milliseconds(300); // can shoot bullet only every 0.3 seconds
-                bulletFireClock.restart();
-            }
-            // Metoer spawning
-            if (meteorSpawnClock.getElapsedTime().asSeconds() >= nextSpawnTime)
-            {
-                int randomCol = rand() % COLS;  // Any random column
-                if (grid[0][randomCol] == 0) // Only spawn if that area is empty
-                {
-                    grid[0][randomCol] = 2;
+                    playSound(voices, SOUND_MENU_CLICK);
+                    if (selectedMenuItem == SAVE_SLOTS) // (back to where we came from)
+                    {
+                        currentState = slotMenuSaving ? STATE_PAUSED : STATE_MENU;
+                        selectedMenuItem = slotMenuSaving ? 2 : 1;
+                    }
+                    else if (slotMenuSaving) // (save and quit to the menu, the file is written in the background)
+                    {
+                        queueSave(game, selectedMenuItem);
+                        activeSlot = selectedMenuItem;
+                        hasSavedGame = true;
+                        if (bgMusic.getStatus() != SoundSource::Playing)
+                        {
+                            bgMusic.play();
+                        }
+                        currentState = STATE_MENU;
+                        selectedMenuItem = 0;
+                    }
+                    else if (loadGame(game, selectedMenuItem)) // (carry on exactly where the save left off)
+                    {
+                        activeSlot = selectedMenuItem;
+                        startPlayerGame(game, recording, true, keyframeInterval, replaying, replayTick,
+                                        restartPending, particles);
+                        bgMusic.stop();
+                        currentState = STATE_PLAYING;
+                    }
+                    else
+                    {
+                        cout << "Could not load slot " << selectedMenuItem + 1 << endl;
+                    }
                 }
-                meteorSpawnClock.restart();
-                nextSpawnTime = 1.0f + (rand() % 3);
             }
-            // Enemy Spawining
-            if (enemySpawnClock.getElapsedTime().asSeconds() >= nextEnemySpawnTime)
+        }
+        // Playing Screen
+        else if (currentState == STATE_PLAYING)
+        {
+            Keyboard::Key key;
+            while (currentState == STATE_PLAYING && takeKey(keyPresses, key))
             {
-                int randomCol = rand() % COLS;  // Any random column
-                if (grid[0][randomCol] == 0) // Check empty
+                if (key == Keyboard::P)
                 {
-                    grid[0][randomCol] = 4;
+                    currentState = STATE_PAUSED;
+                    selectedMenuItem = 0;
                 }
-                enemySpawnClock.restart();
-                float baseTime = 2.0f - (level * 0.35f);  // Base spawn time for each level (decreases with level)
-                float variance = 2.5f - (level * 0.35f);  // Random variation int he spawning
-                if (baseTime < 0.5f) // should nowt be too fast
-                    baseTime = 0.5f;
-                if (variance < 1.0f) // should not be too fast
-                    variance = 1.0f;
-                nextEnemySpawnTime = baseTime + (rand() % (int)variance); // calculate time
-            }
-            // Boos spawning
-            if (level >= 3 && bossSpawnClock.getElapsedTime().asSeconds() >= nextBossSpawnTime)
-            {
-                int randomCol = rand() % COLS;  // Any random column
-                if (grid[0][randomCol] == 0) // Check empty
+                else if (key == Keyboard::F5) // quick save without stopping the game
                 {
-                    grid[0][randomCol] = 5;
+                    int slot = activeSlot >= 0 ? activeSlot : 0;
+                    queueSave(game, slot);
+                    activeSlot = slot;
+                    hasSavedGame = true;
+                    char quickSaveBuffer[40];
+                    sprintf(quickSaveBuffer, "Saved to slot %d", slot + 1);
+                    quickSaveText.setString(quickSaveBuffer);
+                    renderStats.textRebuilds++;
+                    quickSaveClock.restart();
+                    showQuickSave = true;
                 }
-                bossSpawnClock.restart();
-                float bossBaseTime = 10.0f - ((level - 3) * 1.5f);  // Decreases with level
-                float bossVariance = 4.0f;  // Random variation
-                // same logic as enemies
-                if (bossBaseTime < 5.0f)
-                    bossBaseTime = 5.0f;
-                nextBossSpawnTime = bossBaseTime + (rand() % (int)bossVariance);
             }
-            // Shield Powerup Spawning
-            if (level >= 3 && shieldPowerupSpawnClock.getElapsedTime().asSeconds() >= nextShieldPowerupSpawnTime)
+            // Run as many fixed ticks as the elapsed time pays for, keeping the leftover for next frame
+            tickAccumulator += frameTime;
+            while (tickAccumulator >= TICK_DT && currentState == STATE_PLAYING)
             {
-                for (int i = 0; i < MAX_SHIELD_POWERUPS; i++) // separate array for powerups
+                tickAccumulator -= TICK_DT;
+                if (replaying && replayTick >= static_cast<long long>(replay.ticks.size())) // replay is over
                 {
-                    if (!shieldPowerupActive[i]) // empty slot
-                    {
-                        int randomCol = rand() % COLS;  // Any random column
-                        shieldPowerupRow[i] = 0;        // Top row
-                        shieldPowerupCol[i] = randomCol;
-                        shieldPowerupActive[i] = true;  // powerup now visible
-                        shieldPowerupDirection[i] = 0;  // move down
-                        break;  // Only 1 powerup
-                    }
+                    replaying = false;
+                    bgMusic.play();
+                    currentState = STATE_MENU;
+                    selectedMenuItem = 0;
+                    break;
                 }
-                shieldPowerupSpawnClock.restart();
-                float shieldBaseTime;
-                float shieldVariance;
-                if (level < 5) // 20-35 seconds for levels 3 and 4
+                Input input = takeTickInput(playerInput, game); // presses since the last tick count, even released ones
+                int shipColBefore = game.spaceshipCol;
+                if (!replaying)
                 {
-                    shieldBaseTime = 20.0f;
-                    shieldVariance = 15.0f;
+                    recordTick(recording, game, input, restartPending);
+                    restartPending = false;
                 }
-                else // 12-20 seconds for level 5
+                const vector<GameEvent>& events = replaying ? playTick(replay, game, replayTick++) : step(game, input);
+                if (showLatency && !replaying)
                 {
-                    shieldBaseTime = 12.0f;
-                    shieldVariance = 8.0f;
+                    latencyTick(latency, playerInput, shipColBefore, game, events,
+                                inputClock.getElapsedTime().asSeconds());
                 }
-                nextShieldPowerupSpawnTime = shieldBaseTime + (rand() % (int)shieldVariance); // calculate time
-            }
-            // meteor speed
-            float meteorMoveSpeed = 0.7f - ((level - 1) * 0.12f); // speed formula based on level (decreases by 0.12s per level)
-            if (meteorMoveSpeed < 0.333f)  // cannot go below 0.333s
-                meteorMoveSpeed = 0.333f;
-            if (meteorMoveClock.getElapsedTime().asSeconds() >= meteorMoveSpeed)
-            {
-                // Loop from bottom to top and update meteor positions
-                for (int r = ROWS - 1; r >= 0; r--)
+                // Sounds and screen changes for everything that happened this tick
                 {
-                    for (int c = 0; c < COLS; c++)
+                    PROFILE_SCOPE(PHASE_EVENTS);
+                    for (size_t i = 0; i < events.size(); i++)
                     {
-                        if (grid[r][c] == 2)
+                        const GameEvent& event = events[i];
+                        bool gameEnded = currentState == STATE_GAME_OVER || currentState == STATE_VICTORY;
+                        if (event.type == EVENT_SHOT)
                         {
-                            if (r == ROWS - 1) // check if it goes below screen
-                            {
-                                grid[r][c] = 0; // remove it
-                            }
-                            else
-                            {
-                                grid[r][c] = 0; // Clear current position
-                                if (grid[r + 1][c] == 0 || grid[r + 1][c] == 2)
-                                {
-                                    grid[r + 1][c] = 2;  // Place meteor in new position
-                                }
-                                else if (grid[r + 1][c] == 1) // collision with player
-                                {
-                                    if (hasShield)
-                                    {
-                                        hasShield = false;
-                                        isInvincible = true;
-                                        invincibilityTimer.restart(); // 2s invincibility
-                                        damageSound.play();
-                                    }
-                                    else if (!isInvincible)
-                                    {
-                                        lives--;
-                                        damageSound.play();
-                                        isInvincible = true;
-                                        invincibilityTimer.restart();
-                                        if (lives <= 0) // game over
-                                        {
-                                            saveHighScoreAndGameOver(score, highScore, saveFile, hasSavedGame,
-                                                                   currentState, selectedMenuItem, loseSound);
-                                        }
-                                    }
-                                }
-                                else if (grid[r + 1][c] == 3) // collision with bullet
-                                {
-                                    int meteorPoints = 1 + (rand() % 2); // Random 1-2 points
-                                    score += meteorPoints;
-                                    explosionSound.play();
-                                    grid[r + 1][c] = 0;
-                                    createExplosionEffect(r + 1, c, hitEffectRow, hitEffectCol, hitEffectTimer,
-                                                        hitEffectActive, MAX_HIT_EFFECTS);
-                                }
-                            }
+                            playSound(voices, SOUND_SHOOT);
                         }
-                    }
-                }
-                meteorMoveClock.restart();
-            }
-            // shield powerup movement
-            if (shieldPowerupMoveClock.getElapsedTime().asSeconds() >= 0.5f)
-            {
-                for (int i = 0; i < MAX_SHIELD_POWERUPS; i++)
-                {
-                    if (shieldPowerupActive[i])
-                    {
-                        if (shieldPowerupRow[i] >= ROWS - 1) // moves below screen
+                        else if (event.type == EVENT_KILL || event.type == EVENT_BULLET_HIT)
                         {
-                            shieldPowerupActive[i] = false;
-                            continue;
+                            playSound(voices, SOUND_EXPLOSION);
                         }
-                        if (grid[shieldPowerupRow[i]][shieldPowerupCol[i]] == 1) // player claimed shield
+                        else if (event.type == EVENT_PLAYER_HIT)
                         {
-                            if (!hasShield) {
-                                hasShield = true;
-                                levelUpSound.play();
-                            }
-                            shieldPowerupActive[i] = false;
-                            continue;
+                            playSound(voices, event.value == 2 ? SOUND_EXPLOSION : SOUND_DAMAGE);
                         }
-                        shieldPowerupRow[i]++; // move down every time
-                        if (grid[shieldPowerupRow[i]][shieldPowerupCol[i]] == 1) // player claimed shield
+                        else if (event.type == EVENT_SHIELD_PICKUP || event.type == EVENT_LEVEL_UP)
                         {
-                            if (!hasShield) {
-                                hasShield = true;
-                                levelUpSound.play();
-                            }
-                            shieldPowerupActive[i] = false;
-                            continue;
+                            playSound(voices, SOUND_LEVEL_UP);
                         }
-                    }
-                }
-                shieldPowerupMoveClock.restart();  // reset timer
-            }
-            // enemy movement logic
-            float enemyMoveSpeed = 0.7f - ((level - 1) * 0.12f);  // same speed logic as meteors
-            if (enemyMoveClock.getElapsedTime().asSeconds() >= enemyMoveSpeed)
-            {
-                for (int r = ROWS - 1; r >= 0; r--)
-                {
-                    for (int c = 0; c < COLS; c++)
-                    {
-                        if (grid[r][c] == 4)
+                        else if (event.type == EVENT_EXPLOSION)
                         {
-                            if (r == ROWS - 1) // enemy reached bottom
-                            {
-                                grid[r][c] = 0;
-                                if (hasShield)
-                                {
-                                    hasShield = false;
-                                    isInvincible = true;
-                                    invincibilityTimer.restart();
-                                    damageSound.play();
-                                }
-                                else if (!isInvincible)
-                                {
-                                    lives--;
-                                    damageSound.play();
-                                    isInvincible = true;
-                                    invincibilityTimer.restart();
-                                    if (lives <= 0)
-                                    {
-                                        saveHighScoreAndGameOver(score, highScore, saveFile, hasSavedGame,
-                                                               currentState, selectedMenuItem, loseSound);
-                                    }
-                                }
-                            }
-                            else
-                            {
-                                grid[r][c] = 0;
-                                if (grid[r + 1][c] == 0 || grid[r + 1][c] == 4)
-                                {
-                                    grid[r + 1][c] = 4;
-                                }
-                                else if (grid[r + 1][c] == 1) // collision with player
-                                {
-                                    if (hasShield)
-                                    {
-                                        hasShield = false;
-                                        isInvincible = true;
-                                        invincibilityTimer.restart();
-                                        explosionSound.play();
-                                    }
-                                    else if (!isInvincible)
-                                    {
-                                        lives--;
-                                        damageSound.play();
-                                        isInvincible = true;
-                                        invincibilityTimer.restart();
-                                        if (lives <= 0)
-                                        {
-                                            saveHighScoreAndGameOver(score, highScore, saveFile, hasSavedGame,
-                                                                   currentState, selectedMenuItem, loseSound);
-                                        }
-                                    }
-                                }
-                                else if (grid[r + 1][c] == 3) // collision with bullet
-                                {
-                                    score += 3;  // 3 score
-                                    killCount++; // +1 kill
-                                    explosionSound.play();
-                                    grid[r + 1][c] = 0;
-                                    createExplosionEffect(r + 1, c, hitEffectRow, hitEffectCol, hitEffectTimer,
-                                                        hitEffectActive, MAX_HIT_EFFECTS);
-                                    // check if level up                    
-                                    int killsNeeded = level * 10;
-                                    if (level < MAX_LEVEL && killCount >= killsNeeded)
-                                    {
-                                        level++;
-                                        levelUpSound.play();
-                                        killCount = 0;
-                                        bossMoveCounter = 0;
-                                        clearEntities(grid);
-                                        resetSpaceship(grid, spaceshipCol);
-                                        currentState = STATE_LEVEL_UP;
-                                        levelUpTimer.restart(); // level up screen time
-                                        levelUpBlinkClock.restart();
-                                    }
-                                    else if (level >= MAX_LEVEL && killCount >= killsNeeded)
-                                    {
-                                        saveHighScoreAndVictory(score, highScore, saveFile, hasSavedGame,
-                                                              currentState, selectedMenuItem, winSound);
-                                    }
-                                }
-                            }
+                            spawnExplosion(particles, (event.col + 0.5f) * CELL_SIZE, (event.row + 0.5f) * CELL_SIZE,
+                                           PARTICLES_PER_EXPLOSION);
                         }
-                    }
-                }
-                enemyMoveClock.restart();
-            }
-            // boss movement logic
-            float bossMoveSpeed = 0.8f - ((level - 3) * 0.1f);  // same speed logic as enemies
-            if (bossMoveSpeed < 0.5f) // cannot go below 0.5s
-                bossMoveSpeed = 0.5f;
-            if (bossMoveClock.getElapsedTime().asSeconds() >= bossMoveSpeed)
-            {
-                for (int r = ROWS - 1; r >= 0; r--)
-                {
-                    for (int c = 0; c < COLS; c++)
-                    {
-                        if (grid[r][c] == 5)
+                        if (event.type == EVENT_LEVEL_UP && !gameEnded)
                         {
-                            if (r == ROWS - 1) // bottom of screen
-                            {
-                                grid[r][c] = 0;
-                                if (hasShield)
-                                {
-                                    hasShield = false;
-                                    isInvincible = true;
-                                    invincibilityTimer.restart();
-                                    damageSound.play();
-                                }
-                                else if (!isInvincible)
-                                {
-                                    lives--;
-                                    damageSound.play();
-                                    isInvincible = true;
-                                    invincibilityTimer.restart();
-                                    if (lives <= 0)
-                                    {
-                                        saveHighScoreAndGameOver(score, highScore, saveFile, hasSavedGame,
-                                                               currentState, selectedMenuItem, loseSound);
-                                    }
-                                }
-                            }
-                            else
-                            {
-                                int nextRow = r + 1;
-                                int nextCell = grid[nextRow][c];
-                                grid[r][c] = 0;
-                                if (nextCell == 0 || nextCell == 5 || nextCell == 6 || nextCell == 2 || nextCell == 4) // move down
-                                {
-                                    grid[nextRow][c] = 5;
-                                }
-                                else if (nextCell == 1) // collision with player
-                                {
-                                    if (hasShield)
-                                    {
-                                        hasShield = false;
-                                        isInvincible = true;
-                                        invincibilityTimer.restart();
-                                        explosionSound.play();
-                                    }
-                                    else if (!isInvincible)
-                                    {
-                                        lives--;
-                                        damageSound.play();
-                                        isInvincible = true;
-                                        invincibilityTimer.restart();
-                                        if (lives <= 0)
-                                        {
-                                            saveHighScoreAndGameOver(score, highScore, saveFile, hasSavedGame,
-                                                                   currentState, selectedMenuItem, loseSound);
-                                        }
-                                    }
-                                }
-                                else if (nextCell == 3) // collision with bullet
-                                {
-                                    score += 5;  // 5 points
-                                    killCount++; // +1 kill
-                                    explosionSound.play();
-                                    grid[nextRow][c] = 0;
-                                    createExplosionEffect(nextRow, c, hitEffectRow, hitEffectCol, hitEffectTimer,
-                                                        hitEffectActive, MAX_HIT_EFFECTS);
-                                    // same level up check logic                    
-                                    int killsNeeded = level * 10;
-                                    if (level < MAX_LEVEL && killCount >= killsNeeded)
-                                    {
-                                        level++;
-                                        levelUpSound.play();
-                                        killCount = 0;
-                                        bossMoveCounter = 0;
-                                        clearEntities(grid);
-                                        resetSpaceship(grid, spaceshipCol);
-                                        currentState = STATE_LEVEL_UP;
-                                        levelUpTimer.restart();
-                                        levelUpBlinkClock.restart();
-                                    }
-                                    else if (level >= MAX_LEVEL && killCount >= killsNeeded)
-                                    {
-                                        saveHighScoreAndVictory(score, highScore, saveFile, hasSavedGame,
-                                                              currentState, selectedMenuItem, winSound);
-                                    }
-                                }
-                            }
+                            clearParticles(particles); // the board was cleared for the next level
+                            currentState = STATE_LEVEL_UP;
+                            levelUpTimer.restart(); // level up screen time
+                            levelUpBlinkClock.restart();
                         }
-                    }
-                }
-                // Boss bullet firing logic
-                bossMoveCounter++; // boss has moved
-                float firingInterval;
-                if (level == 3)
-                {
-                    firingInterval = 4; // fire bullet every 4 movements
-                }
-                else if (level == 4)
-                {
-                    firingInterval = 3; // fire every 3 movements
-                }
-                else
-                {
-                    firingInterval = 2; // fire every 2 movements
-                }
-                if (bossMoveCounter >= firingInterval)
-                {
-                    for (int r = 0; r < ROWS; r++)
-                    {
-                        for (int c = 0; c < COLS; c++)
+                        else if (event.type == EVENT_GAME_OVER && !gameEnded)
                         {
-                            if (grid[r][c] == 5)
-                            {
-                                if (r < ROWS - 1)
-                                {
-                                    int bulletRow = r + 1;  // just below the boss
-                                    if (bulletRow < ROWS && grid[bulletRow][c] == 0)
-                                    {
-                                        grid[bulletRow][c] = 6; // create bullet
-                                    }
-                                }
-                            }
+                            saveHighScoreAndGameOver(game.score, highScore, activeSlot, hasSavedGame,
+                                                   currentState, selectedMenuItem, voices);
                         }
-                    }
-                    bossMoveCounter = 0; // counter reset
-                }
-                bossMoveClock.restart();
-            }
-            // boss bullet miovement logic
-            float bossBulletSpeed = 0.15f; // Move every 0.15 seconds (very fast, regardless of level)
-            if (bossBulletMoveClock.getElapsedTime().asSeconds() >= bossBulletSpeed)
-            {
-                for (int r = ROWS - 1; r >= 0; r--)
-                {
-                    for (int c = 0; c < COLS; c++)
-                    {
-                        if (grid[r][c] == 6)
+                        else if (event.type == EVENT_VICTORY && !gameEnded)
                         {
-                            if (r == ROWS - 1)
-                            {
-                                grid[r][c] = 0; // remove when below screen
-                            }
-                            else
-                            {
-                                grid[r][c] = 0; // Clear current position
-                                if (grid[r + 1][c] == 1) // collision with player
-                                {
-                                    if (hasShield)
-                                    {
-                                        hasShield = false;
-                                        isInvincible = true;
-                                        invincibilityTimer.restart();
-                                        explosionSound.play();
-                                    }
-                                    else if (!isInvincible)
-                                    {
-                                        lives--;
-                                        damageSound.play();
-                                        isInvincible = true;
-                                        invincibilityTimer.restart();
-                                        if (lives <= 0)
-                                        {
-                                            saveHighScoreAndGameOver(score, highScore, saveFile, hasSavedGame,
-                                                                   currentState, selectedMenuItem, loseSound);
-                                        }
-                                    }
-                                    createExplosionEffect(r + 1, c, hitEffectRow, hitEffectCol, hitEffectTimer,
-                                                        hitEffectActive, MAX_HIT_EFFECTS);
-                                }
-                                else if (grid[r + 1][c] == 2 || grid[r + 1][c] == 4)
-                                {
-                                    grid[r + 1][c] = 6; // bullet moves through anything
-                                }
-                                else if (grid[r + 1][c] == 0 || grid[r + 1][c] == 6)
-                                {
-                                    grid[r + 1][c] = 6;
-                                }
-                            }
+                            saveHighScoreAndVictory(game.score, highScore, activeSlot, hasSavedGame,
+                                                  currentState, selectedMenuItem, voices);
                         }
                     }
                 }
-                bossBulletMoveClock.restart();
             }
-            // player bullet movement logic almost the same as the boss one
-            if (bulletMoveClock.getElapsedTime().asSeconds() >= 0.05f)
+            if (currentState != STATE_PLAYING) // left the game this frame, drop the unspent time
             {
-                for (int r = 0; r < ROWS; r++)
-                {
-                    for (int c = 0; c < COLS; c++)
-                    {
-                        if (grid[r][c] == 3)
-                        {
-                            if (r == 0)
-                            {
-                                grid[r][c] = 0; // goes above screen
-                            }
-                            else
-                            {
-                                grid[r][c] = 0;
-                                if (grid[r - 1][c] == 0 || grid[r - 1][c] == 3)
-                                {
-                                    grid[r - 1][c] = 3;  // Move bullet up
-                                }
-                                else if (grid[r - 1][c] == 6) // bullet vs boss bullet
-                                {
-                                    explosionSound.play();
-                                    grid[r - 1][c] = 0; // Destroy both bullets
-                                    createExplosionEffect(r - 1, c, hitEffectRow, hitEffectCol, hitEffectTimer,
-                                                        hitEffectActive, MAX_HIT_EFFECTS);
-                                }
-                                else if (grid[r - 1][c] == 2) // bullet vs meteor
-                                {
-                                    int meteorPoints = 1 + (rand() % 2);
-                                    score += meteorPoints;
-                                    explosionSound.play();
-                                    grid[r - 1][c] = 0;
-                                    createExplosionEffect(r - 1, c, hitEffectRow, hitEffectCol, hitEffectTimer,
-                                                        hitEffectActive, MAX_HIT_EFFECTS);
-                                }
-                                else if (grid[r - 1][c] == 4) // bullet vs enemy
-                                {
-                                    score += 3;
-                                    killCount++;
-                                    explosionSound.play();
-                                    grid[r - 1][c] = 0;
-                                    createExplosionEffect(r - 1, c, hitEffectRow, hitEffectCol, hitEffectTimer,
-                                                        hitEffectActive, MAX_HIT_EFFECTS);
-                                    // levle up check
-                                    int killsNeeded = level * 10;
-                                    if (level < MAX_LEVEL && killCount >= killsNeeded)
-                                    {
-                                        level++;
-                                        levelUpSound.play();
-                                        killCount = 0;
-                                        bossMoveCounter = 0;
-                                        clearEntities(grid);
-                                        resetSpaceship(grid, spaceshipCol);
-                                        currentState = STATE_LEVEL_UP;
-                                        levelUpTimer.restart();
-                                        levelUpBlinkClock.restart();
-                                    }
-                                    else if (level >= MAX_LEVEL && killCount >= killsNeeded)
-                                    {
-                                        saveHighScoreAndVictory(score, highScore, saveFile, hasSavedGame,
-                                                              currentState, selectedMenuItem, winSound);
-                                    }
-                                }
-                                else if (grid[r - 1][c] == 5) // bullet vs boss
-                                {
-                                    score += 5;
-                                    killCount++;
-                                    explosionSound.play();
-                                    grid[r - 1][c] = 0;
-                                    createExplosionEffect(r - 1, c, hitEffectRow, hitEffectCol, hitEffectTimer,
-                                                        hitEffectActive, MAX_HIT_EFFECTS);
-                                    int killsNeeded = level * 10;
-                                    if (level < MAX_LEVEL && killCount >= killsNeeded)
-                                    {
-                                        level++;
-                                        levelUpSound.play();
-                                        killCount = 0;
-                                        bossMoveCounter = 0;
-                                        clearEntities(grid);
-                                        resetSpaceship(grid, spaceshipCol);
-                                        currentState = STATE_LEVEL_UP;
-                                        levelUpTimer.restart();
-                                        levelUpBlinkClock.restart();
-                                    }
-                                    else if (level >= MAX_LEVEL && killCount >= killsNeeded)
-                                    {
-                                        saveHighScoreAndVictory(score, highScore, saveFile, hasSavedGame,
-                                                              currentState, selectedMenuItem, winSound);
-                                    }
-                                }
-                            }
-                        }
-                    }
-                }
-                bulletMoveClock.restart();
+                tickAccumulator = 0.0f;
             }
-            // hit effect management
-            float deltaTime = hitEffectClock.getElapsedTime().asSeconds();
-            for (int i = 0; i < MAX_HIT_EFFECTS; i++)
             {
-                if (hitEffectActive[i])  // all the active effects
-                {
-                    hitEffectTimer[i] += deltaTime;  // time passes
-                    if (hitEffectTimer[i] >= HIT_EFFECT_DURATION)  // check if hit effect visible more than 0.3s
-                    {
-                        hitEffectActive[i] = false; // remove it
-                    }
-                }
+                PROFILE_SCOPE(PHASE_PARTICLES);
+                updateParticles(particles, frameTime);
             }
-            hitEffectClock.restart();
-            if (isInvincible && invincibilityTimer.getElapsedTime().asSeconds() >= INVINCIBILITY_DURATION)  // check if invincibitly over
+            bool gameFinished = currentState == STATE_GAME_OVER || currentState == STATE_VICTORY;
+            if (gameFinished && recordPath != nullptr && !replaying)
             {
-                isInvincible = false;
+                vector<uint8_t> replayBytes;
+                encodeReplay(recording, replayBytes);
+                queueFile(recordPath, replayBytes); // written in the background, the frame carries on
             }
         }
         // Level up screen
@@ -1313,92 +1074,66 @@ int main()
             if (levelUpTimer.getElapsedTime().asSeconds() >= 2.0f) // after 2s back to playing
             {
                 currentState = STATE_PLAYING;
-                restartAllClocks(meteorSpawnClock, meteorMoveClock, enemySpawnClock, enemyMoveClock,
-                                bossSpawnClock, bossMoveClock, bossBulletMoveClock, bulletMoveClock,
-                                shieldPowerupSpawnClock, shieldPowerupMoveClock);
             }
+            keyPresses.clear(); // nothing to pick on this screen
         }
         // Victory screen
         else if (currentState == STATE_VICTORY)
         {
-            if (menuClock.getElapsedTime() >= menuCooldown)  // same menu logic 
+            Keyboard::Key key;
+            while (currentState == STATE_VICTORY && takeKey(keyPresses, key))
             {
-                bool menuAction = false;
-                if (Keyboard::isKeyPressed(Keyboard::Up) || Keyboard::isKeyPressed(Keyboard::W))
+                if (key == Keyboard::Up || key == Keyboard::W)
                 {
                     selectedMenuItem = (selectedMenuItem - 1 + 2) % 2;
-                    menuNavSound.play();
-                    menuAction = true;
+                    playSound(voices, SOUND_MENU_NAV);
                 }
-                else if (Keyboard::isKeyPressed(Keyboard::Down) || Keyboard::isKeyPressed(Keyboard::S))
+                else if (key == Keyboard::Down || key == Keyboard::S)
                 {
                     selectedMenuItem = (selectedMenuItem + 1) % 2;
-                    menuNavSound.play();
-                    menuAction = true;
+                    playSound(voices, SOUND_MENU_NAV);
                 }
-                else if (Keyboard::isKeyPressed(Keyboard::Enter))
+                else if (key == Keyboard::Enter)
                 {
-                    menuClickSound.play();
+                    playSound(voices, SOUND_MENU_CLICK);
                     if (selectedMenuItem == 0)  // (restart Game)
                     {
                         currentState = STATE_PLAYING;
                         // start fresh
-                        lives = 3;
-                        score = 0;
-                        killCount = 0;
-                        level = 1;
-                        bossMoveCounter = 0;
-                        isInvincible = false;
-                        hasShield = false;
-                        clearGrid(grid);
-                        for (int i = 0; i < MAX_SHIELD_POWERUPS; i++)
-                        {
-                            shieldPowerupActive[i] = false;
-                        }
-                        resetSpaceship(grid, spaceshipCol);
-                        restartAllClocks(meteorSpawnClock, meteorMoveClock, enemySpawnClock, enemyMoveClock,
-                                        bossSpawnClock, bossMoveClock, bossBulletMoveClock, bulletMoveClock,
-                                        shieldPowerupSpawnClock, shieldPowerupMoveClock);
+                        startPlayerGame(game, recording, false, keyframeInterval, replaying, replayTick,
+                                        restartPending, particles);
                     }
                     else if (selectedMenuItem == 1)  // (main menu)
                     {
-                        if (bgMusic.getStatus() != Music::Playing)
+                        if (bgMusic.getStatus() != SoundSource::Playing)
                         {
                             bgMusic.play();
                         }
                         currentState = STATE_MENU;
                         selectedMenuItem = 0;
                     }
-                    menuAction = true;
-                }
-
-                if (menuAction)
-                {
-                    menuClock.restart();
                 }
             }
         }
         // Pause screen
         else if (currentState == STATE_PAUSED)
         {
-            if (menuClock.getElapsedTime() >= menuCooldown) // same menu logic
+            Keyboard::Key key;
+            while (currentState == STATE_PAUSED && takeKey(keyPresses, key))
             {
-                bool menuAction = false;
-                if (Keyboard::isKeyPressed(Keyboard::Up) || Keyboard::isKeyPressed(Keyboard::W))
+                if (key == Keyboard::Up || key == Keyboard::W)
                 {
                     selectedMenuItem = (selectedMenuItem - 1 + 3) % 3;
-                    menuNavSound.play();
-                    menuAction = true;
+                    playSound(voices, SOUND_MENU_NAV);
                 }
-                else if (Keyboard::isKeyPressed(Keyboard::Down) || Keyboard::isKeyPressed(Keyboard::S))
+                else if (key == Keyboard::Down || key == Keyboard::S)
                 {
                     selectedMenuItem = (selectedMenuItem + 1) % 3;
-                    menuNavSound.play();
-                    menuAction = true;
+                    playSound(voices, SOUND_MENU_NAV);
                 }
-                else if (Keyboard::isKeyPressed(Keyboard::Enter))
+                else if (key == Keyboard::Enter)
                 {
-                    menuClickSound.play();
+                    playSound(voices, SOUND_MENU_CLICK);
                     if (selectedMenuItem == 0) // (resume game)
                     {
                         currentState = STATE_PLAYING;
@@ -1406,52 +1141,41 @@ int main()
                     else if (selectedMenuItem == 1)  // (restart level)
                     {
                         currentState = STATE_PLAYING;
-                        killCount = 0;
-                        bossMoveCounter = 0;
-                        isInvincible = false;
-                        hasShield = false;
-                        clearGrid(grid);
-                        for (int i = 0; i < MAX_SHIELD_POWERUPS; i++)
+                        clearParticles(particles);
+                        if (replaying) // restart the replay from the top
                         {
-                            shieldPowerupActive[i] = false;
+                            startPlayback(replay, game);
+                            replayTick = 0;
                         }
-                        resetSpaceship(grid, spaceshipCol);
-                        restartAllClocks(meteorSpawnClock, meteorMoveClock, enemySpawnClock, enemyMoveClock,
-                                        bossSpawnClock, bossMoveClock, bossBulletMoveClock, bulletMoveClock,
-                                        shieldPowerupSpawnClock, shieldPowerupMoveClock);
-                    }
-                    else if (selectedMenuItem == 2)  // (save and quit
-                    {
-                        ofstream outputFile(saveFile); // open file and save all score etc to it
-                        if (outputFile.is_open())
-                        {
-                            outputFile << highScore << " " << lives << " " << score << " " << level;
-                            outputFile.close();
-                            hasSavedGame = true;
-                            savedLives = lives;
-                            savedScore = score;
-                            savedLevel = level;
-                        }
-                        if (bgMusic.getStatus() != Music::Playing)
+                        else
                         {
-                            bgMusic.play();
+                            restartLevel(game);
+                            restartPending = true;
                         }
-                        currentState = STATE_MENU;
-                        selectedMenuItem = 0;
                     }
-                    menuAction = true;
+                    else if (selectedMenuItem == 2)  // (save and quit, pick a slot first)
+                    {
+                        slotMenuSaving = true;
+                        slotTitle.setString("SAVE GAME");
+                        slotTitle.setPosition(windowWidth / 2 - slotTitle.getLocalBounds().width / 2.0f, 100);
+                        renderStats.textRebuilds++;
+                        updateSlotTexts(slotItems, windowWidth / 2.0f, renderStats);
+                        currentState = STATE_SAVE_SLOTS;
+                        selectedMenuItem = activeSlot >= 0 ? activeSlot : 0;
+                    }
                 }
-                else if (Keyboard::isKeyPressed(Keyboard::P))
+                else if (key == Keyboard::P)
                 {
                     currentState = STATE_PLAYING;
-                    menuAction = true;
-                }
-                if (menuAction)
-                {
-                    menuClock.restart();
                 }
             }
         }
+        if (currentState != STATE_PLAYING) // a press made in a menu must not fire once the game is back
+        {
+            clearPresses(playerInput);
+            latencyDiscardPending(latency); // acted on by the tick that left the game
+        }
+        flushSounds(voices); // everything this frame's ticks and menus asked for, started together
         // SFML Rendering for each Game Screen
         window.clear(Color(40, 40, 40)); // Dark Gray Backfground
         // Menu Screen
@@ -1459,11 +1183,8 @@ int main()
         {
             window.draw(menuBackground);
             window.draw(menuTitle);
-            char menuHighScoreBuffer[50];
-            sprintf(menuHighScoreBuffer, "High Score: %d", highScore); // %d fetches from highscore var and updates the string
-            menuHighScoreText.setString(menuHighScoreBuffer);
-            menuHighScoreText.setPosition(windowWidth / 2 - menuHighScoreText.getLocalBounds().width / 2.0f, 180);
-            window.draw(menuHighScoreText);
+            updateNumberText(menuHighScoreText, highScore, 0, renderStats);
+            window.draw(menuHighScoreText.text);
             for (int i = 0; i < 4; i++)
             {
                 menuItems[i].setFillColor(i == selectedMenuItem ? Color::Yellow : Color::White);
@@ -1518,186 +1239,111 @@ int main()
         // Playing Screen
         else if (currentState == STATE_PLAYING)
         {
-            window.draw(background);
-            window.draw(gameBox);
-            // File all the grid with relevant sprites based on 0-6
-            for (int r = 0; r < ROWS; r++)
+            window.setView(boardView);
+            drawCounted(window, background, renderStats);
+            // File all the grid with relevant sprites based on 0-6, plus powerups, shield and hit effects
+            bool showSpaceship = !game.isInvincible || ((int)(game.timers[TIMER_INVINCIBILITY] * 10) % 2 == 0);
             {
-                for (int c = 0; c < COLS; c++)
-                {
-                    if (grid[r][c] == 1)
-                    {
-                        spaceship.setPosition(MARGIN + c * CELL_SIZE, MARGIN + r * CELL_SIZE);
-                        if (!isInvincible || ((int)(invincibilityTimer.getElapsedTime().asMilliseconds() / 100) % 2 == 0))
-                        {
-                            window.draw(spaceship);
-                        }
-                    }
-                    else if (grid[r][c] == 2)
-                    {
-                        meteor.setPosition(MARGIN + c * CELL_SIZE, MARGIN + r * CELL_SIZE);
-                        window.draw(meteor);
-                    }
-                    else if (grid[r][c] == 3)
-                    {
-                        bullet.setPosition(MARGIN + c * CELL_SIZE + BULLET_OFFSET_X, MARGIN + r * CELL_SIZE);
-                        window.draw(bullet);
-                    }
-                    else if (grid[r][c] == 4)
-                    {
-                        enemy.setPosition(MARGIN + c * CELL_SIZE, MARGIN + r * CELL_SIZE);
-                        window.draw(enemy);
-                    }
-                    else if (grid[r][c] == 5)
-                    {
-                        bossEnemy.setPosition(MARGIN + c * CELL_SIZE, MARGIN + r * CELL_SIZE);
-                        window.draw(bossEnemy);
-                    }
-                    else if (grid[r][c] == 6)
-                    {
-                        bossBullet.setPosition(MARGIN + c * CELL_SIZE + BULLET_OFFSET_X, MARGIN + r * CELL_SIZE);
-                        window.draw(bossBullet);
-                    }
-                }
+                PROFILE_SCOPE(PHASE_BOARD);
+                drawnSinceTick = tickAccumulator;
+                buildBoardBatch(game, boardBatch, showSpaceship, drawnSinceTick);
+                addParticles(boardBatch, particles);
+                drawBatch(window, boardBatch, renderStats);
             }
-            // Show all powerups
-            for (int i = 0; i < MAX_SHIELD_POWERUPS; i++)
+            window.setView(window.getDefaultView());
+            drawCounted(window, gameBox, renderStats);
             {
-                if (shieldPowerupActive[i])
+                PROFILE_SCOPE(PHASE_HUD);
+                // Icon for lives remaining
+                for (int i = 0; i < game.lives; i++) // draw based on how many left
                 {
-                    shieldPowerUp.setPosition(MARGIN + shieldPowerupCol[i] * CELL_SIZE, MARGIN + shieldPowerupRow[i] * CELL_SIZE); // set posioton relative to the grid
-                    window.draw(shieldPowerUp);
+                    lifeIcon.setPosition(lifeIconStartX + (i * 28), lifeIconY); // + (i*28) so that they dont draw on top of each other
+                    drawCounted(window, lifeIcon, renderStats);
                 }
+                updateNumberText(scoreText, game.score, 0, renderStats);
+                updateNumberText(killsText, game.killCount, game.level * 10, renderStats);
+                updateNumberText(levelText, game.level, 0, renderStats);
+                updateNumberText(highScoreText, highScore, 0, renderStats);
+                drawCounted(window, title, renderStats);
+                drawCounted(window, livesText, renderStats);
+                drawCounted(window, scoreText.text, renderStats);
+                drawCounted(window, killsText.text, renderStats);
+                drawCounted(window, levelText.text, renderStats);
+                drawCounted(window, highScoreText.text, renderStats);
             }
-            if (hasShield) // draw shield over the player
-            {
-                shieldIcon.setPosition(MARGIN + spaceshipCol * CELL_SIZE + SHIELD_OFFSET, MARGIN + (ROWS - 1) * CELL_SIZE + SHIELD_OFFSET);
-                window.draw(shieldIcon);
-            }
-            for (int i = 0; i < MAX_HIT_EFFECTS; i++)
+            if (showLatency)
             {
-                if (hitEffectActive[i])
-                {
-                    bulletHit.setPosition(MARGIN + hitEffectCol[i] * CELL_SIZE, MARGIN + hitEffectRow[i] * CELL_SIZE);
-                    window.draw(bulletHit);
-                }
+                latencyDrawn(latency, inputClock.getElapsedTime().asSeconds());
             }
-            livesText.setString("Lives:");
-            // Icon for lives remaining
-            float lifeIconStartX = livesText.getPosition().x + livesText.getLocalBounds().width + 10;
-            float lifeIconY = livesText.getPosition().y + (livesText.getLocalBounds().height / 2.0f) - 12;
-            for (int i = 0; i < lives; i++) // draw based on how many left
+            if (showQuickSave && quickSaveClock.getElapsedTime().asSeconds() < 1.5f)
             {
-                lifeIcon.setPosition(lifeIconStartX + (i * 28), lifeIconY); // + (i*28) so that they dont draw on top of each other
-                window.draw(lifeIcon);
+                drawCounted(window, quickSaveText, renderStats);
             }
-            char scoreBuffer[20];
-            sprintf(scoreBuffer, "Score: %d", score); // same update logic
-            scoreText.setString(scoreBuffer);
-            char killsBuffer[50];
-            sprintf(killsBuffer, "Kills: %d/%d", killCount, level * 10);
-            killsText.setString(killsBuffer);
-            char levelBuffer[20];
-            sprintf(levelBuffer, "Level: %d", level);
-            levelText.setString(levelBuffer);
-            char highScoreBuffer[50];
-            sprintf(highScoreBuffer, "High Score: %d", highScore);
-            highScoreText.setString(highScoreBuffer);
-            window.draw(title);
-            window.draw(livesText);
-            window.draw(scoreText);
-            window.draw(killsText);
-            window.draw(levelText);
-            window.draw(highScoreText);
         }
         // Level Up Screen
         else if (currentState == STATE_LEVEL_UP)
         {
-            window.draw(background);
-            window.draw(gameBox);
-            spaceship.setPosition(MARGIN + spaceshipCol * CELL_SIZE, MARGIN + (ROWS - 1) * CELL_SIZE);
-            window.draw(spaceship);
+            window.setView(boardView);
+            drawCounted(window, background, renderStats);
+            spaceship.setPosition(game.spaceshipCol * CELL_SIZE, (game.rows - 1) * CELL_SIZE);
+            drawCounted(window, spaceship, renderStats);
+            window.setView(window.getDefaultView());
+            drawCounted(window, gameBox, renderStats);
             if (levelUpBlinkState)
             {
-                window.draw(levelUpText);
+                drawCounted(window, levelUpText, renderStats);
             }
-            char levelBuffer[20];
-            sprintf(levelBuffer, "Level: %d", level);
-            levelText.setString(levelBuffer);
-
-            char killsBuffer[50];
-            sprintf(killsBuffer, "Kills: %d/%d", killCount, level * 10);
-            killsText.setString(killsBuffer);
-
+            updateNumberText(levelText, game.level, 0, renderStats);
+            updateNumberText(killsText, game.killCount, game.level * 10, renderStats);
             // Draw UI elements (same as gameplay screen)
-            window.draw(title);
-            window.draw(livesText);
-            window.draw(scoreText);
-            window.draw(killsText);
-            window.draw(levelText);
+            drawCounted(window, title, renderStats);
+            drawCounted(window, livesText, renderStats);
+            drawCounted(window, scoreText.text, renderStats);
+            drawCounted(window, killsText.text, renderStats);
+            drawCounted(window, levelText.text, renderStats);
         }
         // Pause Screen
         else if (currentState == STATE_PAUSED)
         {
-            window.draw(background);
-            window.draw(gameBox);
-            for (int r = 0; r < ROWS; r++)
+            window.setView(boardView);
+            drawCounted(window, background, renderStats);
             {
-                for (int c = 0; c < COLS; c++)
-                {
-                    if (grid[r][c] == 1)  // Spaceship
-                    {
-                        spaceship.setPosition(MARGIN + c * CELL_SIZE, MARGIN + r * CELL_SIZE);
-                        window.draw(spaceship);
-                    }
-                    else if (grid[r][c] == 2)  // Meteor
-                    {
-                        meteor.setPosition(MARGIN + c * CELL_SIZE, MARGIN + r * CELL_SIZE);
-                        window.draw(meteor);
-                    }
-                    else if (grid[r][c] == 3)  // Player Bullet
-                    {
-                        bullet.setPosition(MARGIN + c * CELL_SIZE + BULLET_OFFSET_X, MARGIN + r * CELL_SIZE);
-                        window.draw(bullet);
-                    }
-                    else if (grid[r][c] == 4)  // Enemy
-                    {
-                        enemy.setPosition(MARGIN + c * CELL_SIZE, MARGIN + r * CELL_SIZE);
-                        window.draw(enemy);
-                    }
-                    else if (grid[r][c] == 5)  // Boss
-                    {
-                        bossEnemy.setPosition(MARGIN + c * CELL_SIZE, MARGIN + r * CELL_SIZE);
-                        window.draw(bossEnemy);
-                    }
-                    else if (grid[r][c] == 6)  // Boss Bullet
-                    {
-                        bossBullet.setPosition(MARGIN + c * CELL_SIZE + BULLET_OFFSET_X, MARGIN + r * CELL_SIZE);
-                        window.draw(bossBullet);
-                    }
-                }
+                PROFILE_SCOPE(PHASE_BOARD);
+                buildBoardBatch(game, boardBatch, true, drawnSinceTick);
+                drawBatch(window, boardBatch, renderStats);
             }
-            RectangleShape overlay(Vector2f(COLS * CELL_SIZE, ROWS * CELL_SIZE));
+            window.setView(window.getDefaultView());
+            drawCounted(window, gameBox, renderStats);
+            RectangleShape overlay(Vector2f(boardWidth, boardHeight));
             overlay.setPosition(MARGIN, MARGIN);
             overlay.setFillColor(Color(0, 0, 0, 150)); // semi transparent background
-            window.draw(overlay);
-            window.draw(pauseTitle);
+            drawCounted(window, overlay, renderStats);
+            drawCounted(window, pauseTitle, renderStats);
             for (int i = 0; i < 3; i++)
             {
                 pauseItems[i].setFillColor(i == selectedMenuItem ? Color::Yellow : Color::White);
-                window.draw(pauseItems[i]);
+                drawCounted(window, pauseItems[i], renderStats);
+            }
+        }
+        // Save Slot Screen
+        else if (currentState == STATE_SAVE_SLOTS)
+        {
+            window.draw(menuBackground);
+            window.draw(slotTitle);
+            for (int i = 0; i <= SAVE_SLOTS; i++)
+            {
+                slotItems[i].setFillColor(i == selectedMenuItem ? Color::Yellow : Color::White);
+                window.draw(slotItems[i]);
             }
+            window.draw(menuInstructions);
         }
         // Victory Screen
         else if (currentState == STATE_VICTORY)
         {
             window.draw(menuBackground);
             window.draw(victoryTitle);
-            char victoryScoreBuffer[50];
-            sprintf(victoryScoreBuffer, "Final Score: %d", score); // same update logic
-            victoryScore.setString(victoryScoreBuffer);
-            victoryScore.setPosition(windowWidth / 2 - victoryScore.getLocalBounds().width / 2.0f, 200);
-            window.draw(victoryScore);
+            updateNumberText(victoryScore, game.score, 0, renderStats);
+            window.draw(victoryScore.text);
             for (int i = 0; i < 2; i++)
             {
                 victoryItems[i].setFillColor(i == selectedMenuItem ? Color::Yellow : Color::White);
@@ -1710,11 +1356,8 @@ int main()
         {
             window.draw(menuBackground);
             window.draw(gameOverTitle);
-            char gameOverScoreBuffer[50];
-            sprintf(gameOverScoreBuffer, "Final Score: %d", score);
-            gameOverScore.setString(gameOverScoreBuffer);
-            gameOverScore.setPosition(windowWidth / 2 - gameOverScore.getLocalBounds().width / 2.0f, 200);
-            window.draw(gameOverScore);
+            updateNumberText(gameOverScore, game.score, 0, renderStats);
+            window.draw(gameOverScore.text);
             for (int i = 0; i < 2; i++)
             {
                 gameOverItems[i].setFillColor(i == selectedMenuItem ? Color::Yellow : Color::White);
@@ -1722,8 +1365,68 @@ int main()
             }
             window.draw(gameOverInstructions);
         }
+        if (showProfiler)
+        {
+            if (profilerClock.getElapsedTime().asSeconds() >= 0.5f)
+            {
+                PhaseSummary summaries[PHASE_COUNT];
+                summarizePhases(summaries);
+                string lines = "phase: avg / p99 ms per frame\n";
+                for (int phase = 0; phase < PHASE_COUNT; phase++)
+                {
+                    char line[80];
+                    sprintf(line, "%s: %.2f / %.2f\n", PHASE_NAMES[phase], summaries[phase].averageMs,
+                            summaries[phase].p99Ms);
+                    lines += line;
+                }
+                profilerText.setString(lines);
+                renderStats.textRebuilds++;
+                profilerClock.restart();
+            }
+            window.setView(window.getDefaultView());
+            drawCounted(window, profilerBox, renderStats);
+            drawCounted(window, profilerText, renderStats);
+        }
         // After Drawing everything, display it on the screen
-        window.display();
+        {
+            PROFILE_SCOPE(PHASE_DISPLAY);
+            window.display();
+        }
+        if (showLatency)
+        {
+            latencyDisplayed(latency, inputClock.getElapsedTime().asSeconds());
+        }
+        if (showDrawStats && drawStatsClock.getElapsedTime().asSeconds() >= 1.0f)
+        {
+            cout << "draw calls: " << renderStats.drawCalls << "  board sprites: " << renderStats.sprites
+                 << "  text rebuilds: " << renderStats.textRebuilds << "  hit effects: " << game.hitEffects.row.size()
+                 << " (" << game.hitEffects.overflow << " dropped)  particles: " << particles.count << " ("
+                 << particles.overflow << " dropped)" << endl;
+            drawStatsClock.restart();
+        }
+        renderStats.drawCalls = 0;
+        renderStats.sprites = 0;
+        renderStats.textRebuilds = 0;
+        if (showVoiceStats && voiceStatsClock.getElapsedTime().asSeconds() >= 1.0f)
+        {
+            const VoiceStats& stats = voices.stats;
+            cout << "sounds: " << stats.requests << " requested  " << stats.merged << " merged  " << stats.played
+                 << " played  " << stats.stolen << " stolen  " << stats.dropped << " dropped" << endl;
+            voiceStatsClock.restart();
+        }
+    }
+    if (recordPath != nullptr && !recording.ticks.empty()) // window closed, keep whatever was played
+    {
+        vector<uint8_t> replayBytes;
+        encodeReplay(recording, replayBytes);
+        queueFile(recordPath, replayBytes);
+    }
+    flushSaves(); // don't quit with saves still queued
+    if (showLatency)
+    {
+        printLatencyReport(latency, true);
     }
+    endProfileFrame();
+    stopTrace();
     return 0;
 }
@@ -0,0 +1,268 @@
+#include "pack.h"
+#include "bytes.h"
+#include <algorithm>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+using namespace std;
+const char PACK_MAGIC[4] = {'S', 'S', 'P', 'K'};
+const size_t PACK_ALIGN = 16;
+bool writePack(const char directory[], const char path[])
+{
+    // Every file under the directory, named by its path inside it with forward slashes
+    vector<PackEntry> entries;
+    vector<filesystem::path> files;
+    error_code error;
+    for (filesystem::recursive_directory_iterator it(directory, error), end; !error && it != end; it.increment(error))
+    {
+        if (it->is_regular_file())
+        {
+            PackEntry entry;
+            entry.name = filesystem::relative(it->path(), directory).generic_string();
+            entry.offset = 0;
+            entry.size = 0;
+            entries.push_back(entry);
+            files.push_back(it->path());
+        }
+    }
+    if (error || entries.empty())
+    {
+        cerr << "Failed to read assets from " << directory << endl;
+        return false;
+    }
+    vector<int> order(entries.size());
+    for (size_t i = 0; i < order.size(); i++)
+    {
+        order[i] = static_cast<int>(i);
+    }
+    sort(order.begin(), order.end(), [&entries](int a, int b) { return entries[a].name < entries[b].name; });
+    // Read everything, then lay the data out after the index
+    vector<vector<char>> contents(entries.size());
+    size_t indexSize = 4 + 4 + 4;
+    for (size_t i = 0; i < entries.size(); i++)
+    {
+        ifstream file(files[i], ios::binary);
+        if (!file.is_open())
+        {
+            cerr << "Failed to read " << files[i].string() << endl;
+            return false;
+        }
+        contents[i].assign(istreambuf_iterator<char>(file), istreambuf_iterator<char>());
+        entries[i].size = contents[i].size();
+        indexSize += 2 + entries[i].name.size() + 8 + 8;
+    }
+    uint64_t offset = indexSize;
+    for (size_t k = 0; k < order.size(); k++)
+    {
+        offset = (offset + PACK_ALIGN - 1) / PACK_ALIGN * PACK_ALIGN;
+        entries[order[k]].offset = offset;
+        offset += entries[order[k]].size;
+    }
+    vector<uint8_t> bytes(PACK_MAGIC, PACK_MAGIC + 4);
+    putLittleEndian(bytes, PACK_VERSION, 4);
+    putLittleEndian(bytes, entries.size(), 4);
+    for (size_t k = 0; k < order.size(); k++)
+    {
+        const PackEntry& entry = entries[order[k]];
+        putLittleEndian(bytes, entry.name.size(), 2);
+        bytes.insert(bytes.end(), entry.name.begin(), entry.name.end());
+        putLittleEndian(bytes, entry.offset, 8);
+        putLittleEndian(bytes, entry.size, 8);
+    }
+    for (size_t k = 0; k < order.size(); k++)
+    {
+        bytes.resize(entries[order[k]].offset, 0); // padding up to the entry
+        bytes.insert(bytes.end(), contents[order[k]].begin(), contents[order[k]].end());
+    }
+    ofstream out(path, ios::binary | ios::trunc);
+    if (!out.is_open())
+    {
+        cerr << "Failed to write " << path << endl;
+        return false;
+    }
+    out.write(reinterpret_cast<const char*>(bytes.data()), bytes.size());
+    return out.good();
+}
+bool mapFile(MappedFile& mapped, const char path[])
+{
+    mapped.data = nullptr;
+    mapped.size = 0;
+#ifdef _WIN32
+    HANDLE file = CreateFileA(path, GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+    if (file == INVALID_HANDLE_VALUE)
+    {
+        return false;
+    }
+    LARGE_INTEGER fileSize;
+    HANDLE mapping = NULL;
+    if (GetFileSizeEx(file, &fileSize) && fileSize.QuadPart > 0)
+    {
+        mapping = CreateFileMappingA(file, NULL, PAGE_READONLY, 0, 0, NULL);
+    }
+    const void* view = mapping != NULL ? MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0) : NULL;
+    if (view == NULL)
+    {
+        if (mapping != NULL)
+            CloseHandle(mapping);
+        CloseHandle(file);
+        return false;
+    }
+    mapped.data = static_cast<const uint8_t*>(view);
+    mapped.size = static_cast<size_t>(fileSize.QuadPart);
+    mapped.mapping = mapping;
+    mapped.handle = file;
+#else
+    int file = open(path, O_RDONLY);
+    if (file < 0)
+    {
+        return false;
+    }
+    struct stat info;
+    void* view = MAP_FAILED;
+    if (fstat(file, &info) == 0 && info.st_size > 0)
+    {
+        view = mmap(NULL, static_cast<size_t>(info.st_size), PROT_READ, MAP_PRIVATE, file, 0);
+    }
+    close(file); // the mapping keeps the file alive
+    if (view == MAP_FAILED)
+    {
+        return false;
+    }
+    mapped.data = static_cast<const uint8_t*>(view);
+    mapped.size = static_cast<size_t>(info.st_size);
+    mapped.mapping = view;
+    mapped.handle = nullptr;
+#endif
+    return true;
+}
+void unmapFile(MappedFile& mapped)
+{
+    if (mapped.data == nullptr)
+    {
+        return;
+    }
+#ifdef _WIN32
+    UnmapViewOfFile(mapped.data);
+    CloseHandle(static_cast<HANDLE>(mapped.mapping));
+    CloseHandle(static_cast<HANDLE>(mapped.handle));
+#else
+    munmap(mapped.mapping, mapped.size);
+#endif
+    mapped.data = nullptr;
+    mapped.size = 0;
+}
+void closePack(AssetPack& pack)
+{
+    unmapFile(pack.file);
+    pack.entries.clear();
+}
+bool openPack(AssetPack& pack, const char path[])
+{
+    pack.entries.clear();
+    if (!mapFile(pack.file, path))
+    {
+        cerr << "Failed to open asset pack " << path << endl;
+        return false;
+    }
+    // Read the index, checking every entry lies inside the file
+    const uint8_t* data = pack.file.data;
+    size_t size = pack.file.size;
+    size_t pos = 12;
+    bool valid = size >= pos && equal(data, data + 4, PACK_MAGIC) &&
+                 getLittleEndian(data + 4, 4) == PACK_VERSION;
+    uint64_t count = valid ? getLittleEndian(data + 8, 4) : 0;
+    for (uint64_t i = 0; valid && i < count; i++)
+    {
+        if (size - pos < 2)
+        {
+            valid = false;
+            break;
+        }
+        size_t nameLength = static_cast<size_t>(getLittleEndian(data + pos, 2));
+        pos += 2;
+        if (size - pos < nameLength + 16)
+        {
+            valid = false;
+            break;
+        }
+        PackEntry entry;
+        entry.name.assign(reinterpret_cast<const char*>(data + pos), nameLength);
+        pos += nameLength;
+        entry.offset = getLittleEndian(data + pos, 8);
+        entry.size = getLittleEndian(data + pos + 8, 8);
+        pos += 16;
+        valid = entry.offset <= size && entry.size <= size - entry.offset &&
+                (pack.entries.empty() || pack.entries.back().name < entry.name);
+        pack.entries.push_back(entry);
+    }
+    if (!valid)
+    {
+        cerr << path << " is not an asset pack this version can read" << endl;
+        closePack(pack);
+        return false;
+    }
+    return true;
+}
+bool findPackFile(const AssetPack& pack, const char name[], const void*& data, size_t& size)
+{
+    auto it = lower_bound(pack.entries.begin(), pack.entries.end(), name,
+                          [](const PackEntry& entry, const char* key) { return entry.name < key; });
+    if (it == pack.entries.end() || it->name != name)
+    {
+        cerr << name << " is missing from the asset pack" << endl;
+        return false;
+    }
+    data = pack.file.data + it->offset;
+    size = static_cast<size_t>(it->size);
+    return true;
+}
+vector<string> listPackFiles(const AssetPack& pack, const char folder[], const char extension[])
+{
+    vector<string> names;
+    string prefix = folder;
+    string suffix = extension;
+    for (size_t i = 0; i < pack.entries.size(); i++)
+    {
+        const string& name = pack.entries[i].name;
+        if (name.size() >= prefix.size() + suffix.size() && name.compare(0, prefix.size(), prefix) == 0 &&
+            name.compare(name.size() - suffix.size(), suffix.size(), suffix) == 0)
+        {
+            names.push_back(name);
+        }
+    }
+    return names;
+}
+string findPackPath(const char argv0[])
+{
+    error_code error;
+    filesystem::path executable;
+#ifdef _WIN32
+    char buffer[MAX_PATH];
+    DWORD length = GetModuleFileNameA(NULL, buffer, MAX_PATH);
+    if (length > 0 && length < MAX_PATH)
+    {
+        executable = filesystem::path(string(buffer, length));
+    }
+#else
+    executable = filesystem::read_symlink("/proc/self/exe", error);
+#endif
+    if (executable.empty() || error)
+    {
+        executable = filesystem::absolute(argv0, error);
+    }
+    filesystem::path besideExecutable = executable.parent_path() / PACK_FILE_NAME;
+    if (!executable.empty() && filesystem::exists(besideExecutable, error))
+    {
+        return besideExecutable.string();
+    }
+    return PACK_FILE_NAME;
+}
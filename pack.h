@@ -0,0 +1,42 @@
+// Asset pack: every file under assets/ in one archive, built by tools/pack_builder.cpp
+// The game maps the pack into memory once and SFML decodes straight out of the mapping (loadFromMemory /
+// openFromMemory), so startup opens one file instead of two dozen and never copies the raw bytes.
+// Layout (little-endian): "SSPK", u32 version, u32 entry count, then per entry u16 name length, the name
+// ("images/player.png"), u64 offset and u64 size; file data follows, each starting on a 16 byte boundary.
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+const uint32_t PACK_VERSION = 1;
+const char PACK_FILE_NAME[] = "assets.pack";
+struct PackEntry
+{
+    std::string name;
+    uint64_t offset;
+    uint64_t size;
+};
+// A whole file mapped read-only (mmap / MapViewOfFile)
+struct MappedFile
+{
+    const uint8_t* data;
+    size_t size;
+    void* mapping; // platform handles, for unmapFile
+    void* handle;
+};
+bool mapFile(MappedFile& file, const char path[]); // false if missing or empty
+void unmapFile(MappedFile& file);
+struct AssetPack
+{
+    MappedFile file;
+    std::vector<PackEntry> entries; // sorted by name
+};
+bool writePack(const char directory[], const char path[]); // packs every file under directory
+bool openPack(AssetPack& pack, const char path[]);
+void closePack(AssetPack& pack);
+// Finds a file by name; data points into the mapping and stays valid until closePack
+bool findPackFile(const AssetPack& pack, const char name[], const void*& data, size_t& size);
+// Names under a folder with the given extension, e.g. ("images/", ".png"), in name order
+std::vector<std::string> listPackFiles(const AssetPack& pack, const char folder[], const char extension[]);
+// The pack next to the running executable, whatever the working directory is (falls back to the working directory)
+std::string findPackPath(const char argv0[]);
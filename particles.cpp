@@ -0,0 +1,143 @@
+#include "particles.h"
+#include <cmath>
+#if defined(__SSE__) || defined(_M_X64)
+#include <xmmintrin.h>
+#define PARTICLES_SSE
+#endif
+using namespace std;
+void setupParticles(ParticleSystem& particles, int capacity)
+{
+    particles.capacity = capacity > 0 ? capacity : 0;
+    size_t padded = (particles.capacity + 3) / 4 * 4;
+    particles.x.assign(padded, 0.0f);
+    particles.y.assign(padded, 0.0f);
+    particles.vx.assign(padded, 0.0f);
+    particles.vy.assign(padded, 0.0f);
+    particles.life.assign(padded, 0.0f);
+    particles.count = 0;
+    particles.overflow = 0;
+    particles.rng = 0x9E3779B9u;
+}
+void clearParticles(ParticleSystem& particles)
+{
+    particles.count = 0;
+}
+// xorshift32, 0 .. 1
+float randomUnit(uint32_t& x)
+{
+    x ^= x << 13;
+    x ^= x >> 17;
+    x ^= x << 5;
+    return (x >> 8) * (1.0f / 16777216.0f);
+}
+void spawnExplosion(ParticleSystem& particles, float x, float y, int count)
+{
+    for (int p = 0; p < count; p++)
+    {
+        if (particles.count >= static_cast<size_t>(particles.capacity))
+        {
+            particles.overflow += count - p;
+            return;
+        }
+        size_t i = particles.count++;
+        float angle = randomUnit(particles.rng) * 6.2831853f;
+        float speed = PARTICLE_SPEED * (0.3f + 0.7f * randomUnit(particles.rng));
+        particles.x[i] = x;
+        particles.y[i] = y;
+        particles.vx[i] = cosf(angle) * speed;
+        particles.vy[i] = sinf(angle) * speed;
+        particles.life[i] = PARTICLE_LIFETIME * (0.5f + 0.5f * randomUnit(particles.rng));
+    }
+}
+// One pass moves every particle and drops the burnt out ones: survivors are copied down over the dead ones,
+// so the live ones stay packed at the front. Groups of four survivors, the usual case, go back as a group.
+void updateParticles(ParticleSystem& particles, float dt)
+{
+#ifdef PARTICLES_SSE
+    __m128 step = _mm_set1_ps(dt);
+    __m128 fall = _mm_set1_ps(PARTICLE_GRAVITY * dt);
+    __m128 zero = _mm_setzero_ps();
+    float* x = particles.x.data();
+    float* y = particles.y.data();
+    float* vx = particles.vx.data();
+    float* vy = particles.vy.data();
+    float* life = particles.life.data();
+    size_t count = particles.count;
+    size_t live = 0; // survivors so far, never past i, so nothing is overwritten before it is read
+    // The arrays are padded to a multiple of 4, so the last group may run past count into unused floats
+    for (size_t i = 0; i < count; i += 4)
+    {
+        __m128 velocityX = _mm_loadu_ps(vx + i);
+        __m128 velocityY = _mm_add_ps(_mm_loadu_ps(vy + i), fall);
+        __m128 posX = _mm_add_ps(_mm_loadu_ps(x + i), _mm_mul_ps(velocityX, step));
+        __m128 posY = _mm_add_ps(_mm_loadu_ps(y + i), _mm_mul_ps(velocityY, step));
+        __m128 lifeLeft = _mm_sub_ps(_mm_loadu_ps(life + i), step);
+        int alive = _mm_movemask_ps(_mm_cmpgt_ps(lifeLeft, zero));
+        if (count - i < 4)
+        {
+            alive &= (1 << (count - i)) - 1; // lanes past count are not particles
+        }
+        if (alive == 0xF) // the usual case: four survivors, stored as a group
+        {
+            _mm_storeu_ps(x + live, posX);
+            _mm_storeu_ps(y + live, posY);
+            _mm_storeu_ps(vx + live, velocityX);
+            _mm_storeu_ps(vy + live, velocityY);
+            _mm_storeu_ps(life + live, lifeLeft);
+            live += 4;
+            continue;
+        }
+        float lanes[5][4];
+        _mm_storeu_ps(lanes[0], posX);
+        _mm_storeu_ps(lanes[1], posY);
+        _mm_storeu_ps(lanes[2], velocityX);
+        _mm_storeu_ps(lanes[3], velocityY);
+        _mm_storeu_ps(lanes[4], lifeLeft);
+        for (int lane = 0; lane < 4; lane++)
+        {
+            if (alive & (1 << lane))
+            {
+                x[live] = lanes[0][lane];
+                y[live] = lanes[1][lane];
+                vx[live] = lanes[2][lane];
+                vy[live] = lanes[3][lane];
+                life[live] = lanes[4][lane];
+                live++;
+            }
+        }
+    }
+    particles.count = live;
+#else
+    updateParticlesScalar(particles, dt);
+#endif
+}
+// Burnt out particles are swapped with the last live one, so the live ones stay packed at the front
+void removeDead(ParticleSystem& particles)
+{
+    size_t i = 0;
+    while (i < particles.count)
+    {
+        if (particles.life[i] > 0.0f)
+        {
+            i++;
+            continue;
+        }
+        size_t last = --particles.count;
+        particles.x[i] = particles.x[last];
+        particles.y[i] = particles.y[last];
+        particles.vx[i] = particles.vx[last];
+        particles.vy[i] = particles.vy[last];
+        particles.life[i] = particles.life[last];
+    }
+}
+void updateParticlesScalar(ParticleSystem& particles, float dt)
+{
+    for (size_t i = 0; i < particles.count; i++)
+    {
+        particles.vy[i] += PARTICLE_GRAVITY * dt;
+        particles.x[i] += particles.vx[i] * dt;
+        particles.y[i] += particles.vy[i] * dt;
+        particles.life[i] -= dt;
+    }
+    removeDead(particles);
+}
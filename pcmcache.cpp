@@ -0,0 +1,101 @@
+#include "pcmcache.h"
+#include "bytes.h"
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+using namespace std;
+using namespace sf;
+const char PCM_MAGIC[4] = {'S', 'P', 'C', 'M'};
+const size_t PCM_HEADER_SIZE = 32; // magic, version, source hash, channels, sample rate, sample count
+// FNV-1a of the encoded file
+uint64_t pcmCacheKey(const void* encoded, size_t size)
+{
+    return fnv1a(encoded, size);
+}
+string pcmCacheFolder(const string& packPath)
+{
+    return (filesystem::path(packPath).parent_path() / "pcm-cache").string();
+}
+string pcmCachePath(const string& folder, uint64_t key)
+{
+    char name[32];
+    snprintf(name, sizeof(name), "%016llx.pcm", static_cast<unsigned long long>(key));
+    return (filesystem::path(folder) / name).string();
+}
+bool openPcmCache(PcmAudio& audio, const string& path, uint64_t key)
+{
+    if (!mapFile(audio.cache, path.c_str()))
+    {
+        return false;
+    }
+    const uint8_t* bytes = audio.cache.data;
+    uint64_t sampleCount = audio.cache.size >= PCM_HEADER_SIZE ? getLittleEndian(bytes + 24, 8) : 0;
+    bool valid = audio.cache.size >= PCM_HEADER_SIZE && equal(bytes, bytes + 4, PCM_MAGIC) &&
+                 getLittleEndian(bytes + 4, 4) == PCM_CACHE_VERSION && getLittleEndian(bytes + 8, 8) == key &&
+                 sampleCount == (audio.cache.size - PCM_HEADER_SIZE) / sizeof(Int16) &&
+                 getLittleEndian(bytes + 16, 4) > 0;
+    if (!valid)
+    {
+        cerr << "Ignoring damaged audio cache file " << path << endl;
+        unmapFile(audio.cache);
+        return false;
+    }
+    audio.channelCount = static_cast<unsigned>(getLittleEndian(bytes + 16, 4));
+    audio.sampleRate = static_cast<unsigned>(getLittleEndian(bytes + 20, 4));
+    audio.sampleCount = sampleCount;
+    audio.samples = reinterpret_cast<const Int16*>(bytes + PCM_HEADER_SIZE);
+    audio.fromCache = true;
+    return true;
+}
+bool writePcmCache(const string& path, uint64_t key, const PcmAudio& audio)
+{
+    error_code error;
+    filesystem::create_directories(filesystem::path(path).parent_path(), error);
+    // Written under a temporary name and renamed, so a half written file is never picked up
+    string tempPath = path + ".tmp";
+    {
+        ofstream file(tempPath, ios::binary | ios::trunc);
+        if (!file.is_open())
+        {
+            return false; // read-only install: no cache, decode every launch as before
+        }
+        vector<uint8_t> header(PCM_MAGIC, PCM_MAGIC + 4);
+        putLittleEndian(header, PCM_CACHE_VERSION, 4);
+        putLittleEndian(header, key, 8);
+        putLittleEndian(header, audio.channelCount, 4);
+        putLittleEndian(header, audio.sampleRate, 4);
+        putLittleEndian(header, audio.sampleCount, 8);
+        file.write(reinterpret_cast<const char*>(header.data()), header.size());
+        // samples as they are in memory (every platform the game ships on is little-endian)
+        file.write(reinterpret_cast<const char*>(audio.samples), audio.sampleCount * sizeof(Int16));
+        if (!file.good())
+        {
+            return false;
+        }
+    }
+    remove(path.c_str());
+    return rename(tempPath.c_str(), path.c_str()) == 0;
+}
+void PcmStream::open(const PcmAudio& audio)
+{
+    samples = audio.samples;
+    sampleCount = audio.sampleCount;
+    position = 0;
+    initialize(audio.channelCount, audio.sampleRate);
+}
+bool PcmStream::onGetData(Chunk& data)
+{
+    // about a second per chunk, like sf::Music, handed over without copying
+    Uint64 chunkSize = static_cast<Uint64>(getSampleRate()) * getChannelCount();
+    Uint64 count = min(chunkSize, sampleCount - position);
+    data.samples = samples + position;
+    data.sampleCount = static_cast<size_t>(count);
+    position += count;
+    return position < sampleCount;
+}
+void PcmStream::onSeek(Time offset)
+{
+    Uint64 frame = static_cast<Uint64>(offset.asMicroseconds()) * getSampleRate() / 1000000;
+    position = min(frame * getChannelCount(), sampleCount);
+}
@@ -0,0 +1,39 @@
+// Decoded audio cache
+// The MP3 effects used to be decoded on every launch, and the music kept decoding MP3 for the whole session.
+// Decoded samples are now kept in a pcm-cache folder next to the asset pack, one raw file per sound named
+// after a hash of the encoded file, so an edited sound just gets a new entry. Cache files are mapped rather
+// than read: effects upload straight from the mapping and the music streams out of it with no decoding.
+#pragma once
+#include <SFML/Audio.hpp>
+#include <string>
+#include <vector>
+#include "pack.h"
+const uint32_t PCM_CACHE_VERSION = 1;
+struct PcmAudio
+{
+    const sf::Int16* samples; // into decoded, or into the mapped cache file
+    sf::Uint64 sampleCount;
+    unsigned channelCount;
+    unsigned sampleRate;
+    std::vector<sf::Int16> decoded;
+    MappedFile cache;
+    bool fromCache;
+};
+std::string pcmCacheFolder(const std::string& packPath);
+uint64_t pcmCacheKey(const void* encoded, size_t size); // hash of the encoded file
+std::string pcmCachePath(const std::string& folder, uint64_t key);
+bool openPcmCache(PcmAudio& audio, const std::string& path, uint64_t key); // false if missing or damaged
+bool writePcmCache(const std::string& path, uint64_t key, const PcmAudio& audio);
+// Plays samples that are already in memory, looping like sf::Music but without a decoder behind it
+class PcmStream : public sf::SoundStream
+{
+public:
+    void open(const PcmAudio& audio);
+protected:
+    bool onGetData(Chunk& data) override;
+    void onSeek(sf::Time offset) override;
+private:
+    const sf::Int16* samples = nullptr;
+    sf::Uint64 sampleCount = 0;
+    sf::Uint64 position = 0;
+};
@@ -0,0 +1,108 @@
+#include "profiler.h"
+#include <algorithm>
+#include <cstdio>
+#include <vector>
+using namespace std;
+const char* const PHASE_NAMES[PHASE_COUNT] = {"frame", "input", "player", "spawn", "move meteors", "move shields",
+                                              "move enemies", "move bosses", "move boss bullets", "move bullets",
+                                              "collisions", "hit effects", "events", "particles", "board", "hud",
+                                              "display"};
+bool profilerEnabled = false;
+// Everything below is only touched by the main thread
+vector<ProfileSample> profileSamples(PROFILE_SAMPLES);
+uint64_t samplesWritten = 0;
+uint64_t frameFirstSample = 0; // first sample of the frame in progress
+int64_t frameTotals[PROFILE_FRAMES][PHASE_COUNT];
+int framesRecorded = 0;
+FILE* traceFile = nullptr;
+int64_t traceStart = 0;
+bool traceFirstEvent = true;
+void setProfiling(bool enabled)
+{
+    if (enabled && !profilerEnabled) // start over, old numbers would be from another part of the game
+    {
+        frameFirstSample = samplesWritten;
+        framesRecorded = 0;
+    }
+    profilerEnabled = enabled;
+}
+void recordSample(int phase, int64_t start, int64_t duration)
+{
+    ProfileSample& sample = profileSamples[samplesWritten % PROFILE_SAMPLES];
+    sample.phase = phase;
+    sample.start = start;
+    sample.duration = duration;
+    samplesWritten++;
+}
+void endProfileFrame()
+{
+    if (!profilerEnabled)
+    {
+        return;
+    }
+    // A frame with more samples than the ring holds only keeps its last PROFILE_SAMPLES
+    uint64_t first = max(frameFirstSample, samplesWritten > PROFILE_SAMPLES ? samplesWritten - PROFILE_SAMPLES : 0);
+    int64_t* totals = frameTotals[framesRecorded % PROFILE_FRAMES];
+    fill(totals, totals + PHASE_COUNT, 0);
+    for (uint64_t i = first; i < samplesWritten; i++)
+    {
+        const ProfileSample& sample = profileSamples[i % PROFILE_SAMPLES];
+        totals[sample.phase] += sample.duration;
+        if (traceFile != nullptr)
+        {
+            fprintf(traceFile, "%s\n{\"name\":\"%s\",\"ph\":\"X\",\"pid\":1,\"tid\":1,\"ts\":%.3f,\"dur\":%.3f}",
+                    traceFirstEvent ? "" : ",", PHASE_NAMES[sample.phase], (sample.start - traceStart) / 1000.0,
+                    sample.duration / 1000.0);
+            traceFirstEvent = false;
+        }
+    }
+    framesRecorded++;
+    frameFirstSample = samplesWritten;
+}
+void summarizePhases(PhaseSummary summaries[PHASE_COUNT])
+{
+    int frames = min(framesRecorded, PROFILE_FRAMES);
+    vector<int64_t> values(frames);
+    for (int phase = 0; phase < PHASE_COUNT; phase++)
+    {
+        summaries[phase].averageMs = 0.0;
+        summaries[phase].p99Ms = 0.0;
+        if (frames == 0)
+        {
+            continue;
+        }
+        int64_t sum = 0;
+        for (int f = 0; f < frames; f++)
+        {
+            values[f] = frameTotals[f][phase];
+            sum += values[f];
+        }
+        size_t rank = (frames * 99 + 99) / 100 - 1; // nearest rank
+        nth_element(values.begin(), values.begin() + rank, values.end());
+        summaries[phase].averageMs = sum / 1e6 / frames;
+        summaries[phase].p99Ms = values[rank] / 1e6;
+    }
+}
+bool startTrace(const char path[])
+{
+    traceFile = fopen(path, "w");
+    if (traceFile == nullptr)
+    {
+        return false;
+    }
+    fprintf(traceFile, "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[");
+    traceStart = profileNow();
+    traceFirstEvent = true;
+    setProfiling(true);
+    return true;
+}
+void stopTrace()
+{
+    if (traceFile == nullptr)
+    {
+        return;
+    }
+    fprintf(traceFile, "\n]}\n");
+    fclose(traceFile);
+    traceFile = nullptr;
+}
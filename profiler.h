@@ -0,0 +1,74 @@
+// Frame profiler
+// Scoped timers around each phase of a frame (input, every simulation pass, drawing, display), recorded
+// into a ring buffer on the main thread. The game shows per-phase averages and p99 over the last frames
+// (F3) and can stream every sample to a Chrome trace file (--trace, open it in chrome://tracing or
+// Perfetto). Built without SPACE_SHOOTER_PROFILING, PROFILE_SCOPE is nothing at all; built with it, a
+// scope costs one branch while the profiler is switched off.
+#pragma once
+#include <chrono>
+#include <cstdint>
+// Phases (a phase that runs several times in a frame, like the simulation passes, adds up)
+const int PHASE_FRAME = 0;
+const int PHASE_INPUT = 1;
+const int PHASE_PLAYER = 2;
+const int PHASE_SPAWN = 3;
+const int PHASE_MOVE_METEORS = 4;
+const int PHASE_MOVE_SHIELDS = 5;
+const int PHASE_MOVE_ENEMIES = 6;
+const int PHASE_MOVE_BOSSES = 7;
+const int PHASE_MOVE_BOSS_BULLETS = 8;
+const int PHASE_MOVE_BULLETS = 9;
+const int PHASE_COLLISIONS = 10; // scoring, damage and level ups for everything the passes ran into
+const int PHASE_HIT_EFFECTS = 11;
+const int PHASE_EVENTS = 12;    // sounds and screen changes for what the ticks reported
+const int PHASE_PARTICLES = 13; // explosion debris update
+const int PHASE_BOARD = 14;     // building and drawing the board batch, particles included
+const int PHASE_HUD = 15;
+const int PHASE_DISPLAY = 16;   // window.display(), includes waiting for the frame limit
+const int PHASE_COUNT = 17;
+const int PROFILE_SAMPLES = 1 << 16; // ring of individual timings
+const int PROFILE_FRAMES = 240;      // frames the averages and p99 are taken over
+extern const char* const PHASE_NAMES[PHASE_COUNT];
+struct ProfileSample
+{
+    int phase;
+    int64_t start; // profileNow() when the phase began
+    int64_t duration;
+};
+struct PhaseSummary
+{
+    double averageMs; // per frame
+    double p99Ms;
+};
+extern bool profilerEnabled;
+void setProfiling(bool enabled);
+inline int64_t profileNow() // nanoseconds
+{
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+void recordSample(int phase, int64_t start, int64_t duration);
+// Closes the frame: totals it per phase and writes its samples to the trace, if one is open
+void endProfileFrame();
+void summarizePhases(PhaseSummary summaries[PHASE_COUNT]);
+bool startTrace(const char path[]); // turns profiling on
+void stopTrace();
+struct ProfileScope
+{
+    int phase;
+    int64_t start;
+    explicit ProfileScope(int timedPhase) : phase(timedPhase), start(profilerEnabled ? profileNow() : -1) {}
+    ~ProfileScope()
+    {
+        if (start >= 0)
+        {
+            recordSample(phase, start, profileNow() - start);
+        }
+    }
+};
+#ifdef SPACE_SHOOTER_PROFILING
+#define PROFILE_CONCAT_INNER(a, b) a##b
+#define PROFILE_CONCAT(a, b) PROFILE_CONCAT_INNER(a, b)
+#define PROFILE_SCOPE(phase) ProfileScope PROFILE_CONCAT(profileScope, __LINE__)(phase)
+#else
+#define PROFILE_SCOPE(phase)
+#endif
@@ -0,0 +1,141 @@
+#include "render.h"
+#include <algorithm>
+#include <cstdio>
+using namespace sf;
+void setupBatch(BoardBatch& batch, const Texture& texture)
+{
+    batch.texture = &texture;
+    batch.vertices.setPrimitiveType(Quads);
+    batch.vertices.clear();
+}
+void setupFrame(BoardBatch& batch, int sprite, const IntRect& rect, float scaleX, float scaleY, float offsetY)
+{
+    SpriteFrame& frame = batch.frames[sprite];
+    frame.rect = rect;
+    frame.width = CELL_SIZE * scaleX;
+    frame.height = CELL_SIZE * scaleY;
+    frame.offsetX = (CELL_SIZE - frame.width) / 2.0f;
+    frame.offsetY = offsetY;
+}
+void addSprite(BoardBatch& batch, int sprite, float x, float y)
+{
+    const SpriteFrame& frame = batch.frames[sprite];
+    float left = x + frame.offsetX;
+    float top = y + frame.offsetY;
+    float right = left + frame.width;
+    float bottom = top + frame.height;
+    float texLeft = static_cast<float>(frame.rect.left);
+    float texTop = static_cast<float>(frame.rect.top);
+    float texRight = texLeft + frame.rect.width;
+    float texBottom = texTop + frame.rect.height;
+    batch.vertices.append(Vertex(Vector2f(left, top), Vector2f(texLeft, texTop)));
+    batch.vertices.append(Vertex(Vector2f(right, top), Vector2f(texRight, texTop)));
+    batch.vertices.append(Vertex(Vector2f(right, bottom), Vector2f(texRight, texBottom)));
+    batch.vertices.append(Vertex(Vector2f(left, bottom), Vector2f(texLeft, texBottom)));
+}
+void buildBoardBatch(const GameState& game, BoardBatch& batch, bool showSpaceship, float sinceTick)
+{
+    batch.vertices.clear(); // keeps the memory from last frame
+    // Walk the entity pools rather than the grid, so big boards cost what is on them
+    if (showSpaceship)
+    {
+        addSprite(batch, SPRITE_SPACESHIP, game.spaceshipCol * CELL_SIZE, (game.rows - 1) * CELL_SIZE);
+    }
+    for (size_t b = 0; b < game.bands.size(); b++)
+    {
+        for (int p = 0; p < POOL_COUNT; p++)
+        {
+            const EntityPool& pool = game.bands[b].pools[p];
+            int sprite = p + 1; // pool = grid code - 2, sprite = grid code - 1
+            float progress = moveProgress(game, p, sinceTick);
+            for (size_t i = 0; i < pool.row.size(); i++)
+            {
+                float row = pool.prevRow[i] + (pool.row[i] - pool.prevRow[i]) * progress;
+                addSprite(batch, sprite, pool.col[i] * CELL_SIZE, row * CELL_SIZE);
+            }
+        }
+    }
+    // Show all powerups
+    for (int i = 0; i < MAX_SHIELD_POWERUPS; i++)
+    {
+        if (game.shieldPowerupActive[i])
+        {
+            addSprite(batch, SPRITE_SHIELD_POWERUP, game.shieldPowerupCol[i] * CELL_SIZE, game.shieldPowerupRow[i] * CELL_SIZE);
+        }
+    }
+    if (game.hasShield) // draw shield over the player
+    {
+        addSprite(batch, SPRITE_SHIELD, game.spaceshipCol * CELL_SIZE, (game.rows - 1) * CELL_SIZE);
+    }
+    const HitEffectPool& effects = game.hitEffects;
+    for (size_t i = 0; i < effects.row.size(); i++)
+    {
+        addSprite(batch, SPRITE_HIT_EFFECT, effects.col[i] * CELL_SIZE, effects.row[i] * CELL_SIZE);
+    }
+}
+void addParticles(BoardBatch& batch, const ParticleSystem& particles)
+{
+    const IntRect& rect = batch.frames[SPRITE_HIT_EFFECT].rect;
+    float texLeft = static_cast<float>(rect.left);
+    float texTop = static_cast<float>(rect.top);
+    float texRight = texLeft + rect.width;
+    float texBottom = texTop + rect.height;
+    float half = PARTICLE_SIZE / 2.0f;
+    for (size_t i = 0; i < particles.count; i++)
+    {
+        float left = particles.x[i] - half;
+        float top = particles.y[i] - half;
+        float fade = std::min(1.0f, particles.life[i] / (PARTICLE_LIFETIME * 0.5f));
+        Color color(255, 255, 255, static_cast<Uint8>(255 * fade));
+        batch.vertices.append(Vertex(Vector2f(left, top), color, Vector2f(texLeft, texTop)));
+        batch.vertices.append(Vertex(Vector2f(left + PARTICLE_SIZE, top), color, Vector2f(texRight, texTop)));
+        batch.vertices.append(Vertex(Vector2f(left + PARTICLE_SIZE, top + PARTICLE_SIZE), color,
+                                     Vector2f(texRight, texBottom)));
+        batch.vertices.append(Vertex(Vector2f(left, top + PARTICLE_SIZE), color, Vector2f(texLeft, texBottom)));
+    }
+}
+void drawBatch(RenderTarget& target, const BoardBatch& batch, RenderStats& stats)
+{
+    size_t vertexCount = batch.vertices.getVertexCount();
+    if (vertexCount == 0) // empty board
+    {
+        return;
+    }
+    target.draw(batch.vertices, RenderStates(batch.texture));
+    stats.drawCalls++;
+    stats.sprites += static_cast<int>(vertexCount / 4);
+}
+void drawCounted(RenderTarget& target, const Drawable& drawable, RenderStats& stats)
+{
+    target.draw(drawable);
+    stats.drawCalls++;
+}
+void setupNumberText(NumberText& label, const Font& font, unsigned size, const Color& color, const char* format,
+                     float x, float y, bool centered)
+{
+    label.text.setFont(font);
+    label.text.setCharacterSize(size);
+    label.text.setFillColor(color);
+    label.text.setPosition(x, y);
+    label.format = format;
+    label.built = false;
+    label.centerX = centered ? x : -1.0f;
+}
+void updateNumberText(NumberText& label, int first, int second, RenderStats& stats)
+{
+    if (label.built && label.shown[0] == first && label.shown[1] == second)
+    {
+        return;
+    }
+    char buffer[64];
+    snprintf(buffer, sizeof(buffer), label.format, first, second);
+    label.text.setString(buffer);
+    if (label.centerX >= 0.0f)
+    {
+        label.text.setPosition(label.centerX - label.text.getLocalBounds().width / 2.0f, label.text.getPosition().y);
+    }
+    label.shown[0] = first;
+    label.shown[1] = second;
+    label.built = true;
+    stats.textRebuilds++;
+}
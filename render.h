@@ -0,0 +1,73 @@
+// Batched drawing of the game board
+// Every sprite on the board comes from the texture atlas and is collected into one vertex array, so the
+// whole board is a single draw call no matter how many entities are alive. Positions are in board
+// space (cell c, r at c * CELL_SIZE, r * CELL_SIZE); the caller draws them through a view that fits the
+// board into the window.
+#pragma once
+#include <SFML/Graphics.hpp>
+#include "simulation.h"
+#include "particles.h"
+// Grid Setup
+const int CELL_SIZE = 40;
+const int MARGIN = 40;                                               // Margin around the grid (window pixels)
+const int MAX_BOARD_WIDTH = 1200;                                    // largest the board gets on screen,
+const int MAX_BOARD_HEIGHT = 920;                                    // bigger boards are scaled down to fit
+const float BULLET_OFFSET_X = (CELL_SIZE - CELL_SIZE * 0.3f) / 2.0f; // Center bullets horizontally
+const float SHIELD_OFFSET = CELL_SIZE * -0.15f;                      // Center shield overlay
+const float PARTICLE_SIZE = 8.0f;                                    // explosion debris, board pixels
+// Board Sprites: one per grid code (1-6), then powerups, hit effects and the player's shield
+const int SPRITE_SPACESHIP = 0;
+const int SPRITE_METEOR = 1;
+const int SPRITE_BULLET = 2;
+const int SPRITE_ENEMY = 3;
+const int SPRITE_BOSS = 4;
+const int SPRITE_BOSS_BULLET = 5;
+const int SPRITE_SHIELD_POWERUP = 6;
+const int SPRITE_HIT_EFFECT = 7;
+const int SPRITE_SHIELD = 8;
+const int SPRITE_COUNT = 9;
+// Where a board sprite comes from in the atlas and how it sits inside its cell
+struct SpriteFrame
+{
+    sf::IntRect rect;
+    float width;   // size on screen
+    float height;
+    float offsetX; // shift inside the cell (bullets are centered)
+    float offsetY;
+};
+struct BoardBatch
+{
+    const sf::Texture* texture;
+    sf::VertexArray vertices; // 4 vertices per sprite
+    SpriteFrame frames[SPRITE_COUNT];
+};
+// Counters for the frame being drawn
+struct RenderStats
+{
+    int drawCalls;
+    int sprites;
+    int textRebuilds; // setString calls, each one lays the glyphs out again
+};
+// Text showing up to two numbers (score, kills, level...). It is only formatted and laid out again when a
+// number changes, so a frame where nothing happened does no text work at all.
+struct NumberText
+{
+    sf::Text text;
+    const char* format; // printf format with up to two %d
+    int shown[2];
+    bool built;
+    float centerX;      // centered on this x, or left aligned at the position when < 0
+};
+void setupBatch(BoardBatch& batch, const sf::Texture& texture);
+void setupFrame(BoardBatch& batch, int sprite, const sf::IntRect& rect, float scaleX = 1.0f, float scaleY = 1.0f, float offsetY = 0.0f);
+void addSprite(BoardBatch& batch, int sprite, float x, float y);
+// Moving entities are drawn part of the way from the cell they left on their last move to the one they are
+// in (moveProgress), so they glide at any frame rate instead of jumping a cell per move
+void buildBoardBatch(const GameState& game, BoardBatch& batch, bool showSpaceship, float sinceTick);
+// Small copies of the hit effect sprite, fading out as they burn down, on top of what the batch has
+void addParticles(BoardBatch& batch, const ParticleSystem& particles);
+void drawBatch(sf::RenderTarget& target, const BoardBatch& batch, RenderStats& stats);
+void drawCounted(sf::RenderTarget& target, const sf::Drawable& drawable, RenderStats& stats);
+void setupNumberText(NumberText& label, const sf::Font& font, unsigned size, const sf::Color& color, const char* format,
+                     float x, float y, bool centered);
+void updateNumberText(NumberText& label, int first, int second, RenderStats& stats);
@@ -0,0 +1,296 @@
+#include "replay.h"
+#include "snapshot.h"
+#include "bytes.h"
+#include <algorithm>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+using namespace std;
+const char REPLAY_MAGIC[4] = {'S', 'S', 'R', 'P'};
+void startRecording(Replay& replay, GameState& game, uint64_t seed, int lives, int score, int level,
+                    int keyframeInterval)
+{
+    replay.seed = seed;
+    replay.rows = game.rows;
+    replay.cols = game.cols;
+    replay.lives = lives;
+    replay.score = score;
+    replay.level = level;
+    replay.ticks.clear();
+    replay.keyframeInterval = keyframeInterval;
+    replay.keyframes.clear();
+    replay.startState.clear();
+    seedGame(game, seed);
+    newGame(game, lives, score, level);
+}
+void resumeRecording(Replay& replay, const GameState& game, int keyframeInterval)
+{
+    replay.seed = 0; // the random generators are part of the start state
+    replay.rows = game.rows;
+    replay.cols = game.cols;
+    replay.lives = game.lives;
+    replay.score = game.score;
+    replay.level = game.level;
+    replay.ticks.clear();
+    replay.keyframeInterval = keyframeInterval;
+    replay.keyframes.clear();
+    saveState(game, replay.startState);
+}
+// Keyframe due before this tick? Not on a restart tick: the game is already restarted when it gets recorded,
+// and playback would restart it a second time.
+bool keyframeDue(const Replay& replay, long long tick, bool restart)
+{
+    if (replay.keyframeInterval <= 0 || restart)
+    {
+        return false;
+    }
+    return replay.keyframes.empty() || tick >= replay.keyframes.back().tick + replay.keyframeInterval;
+}
+void addKeyframe(Replay& replay, const GameState& game, long long tick)
+{
+    Keyframe keyframe;
+    keyframe.tick = tick;
+    saveState(game, keyframe.state);
+    replay.keyframes.push_back(keyframe);
+}
+void recordTick(Replay& replay, const GameState& game, const Input& input, bool restart)
+{
+    long long tick = static_cast<long long>(replay.ticks.size());
+    if (keyframeDue(replay, tick, restart))
+    {
+        addKeyframe(replay, game, tick);
+    }
+    uint8_t bits = 0;
+    if (input.left) bits |= REPLAY_LEFT;
+    if (input.right) bits |= REPLAY_RIGHT;
+    if (input.fire) bits |= REPLAY_FIRE;
+    if (restart) bits |= REPLAY_RESTART;
+    replay.ticks.push_back(bits);
+}
+bool startPlayback(const Replay& replay, GameState& game)
+{
+    if (game.rows != replay.rows || game.cols != replay.cols)
+    {
+        setupBoard(game, replay.rows, replay.cols);
+    }
+    if (!replay.startState.empty())
+    {
+        return loadState(game, replay.startState.data(), replay.startState.size());
+    }
+    seedGame(game, replay.seed);
+    newGame(game, replay.lives, replay.score, replay.level);
+    return true;
+}
+Input replayInput(uint8_t bits)
+{
+    Input input;
+    input.left = (bits & REPLAY_LEFT) != 0;
+    input.right = (bits & REPLAY_RIGHT) != 0;
+    input.fire = (bits & REPLAY_FIRE) != 0;
+    return input;
+}
+const vector<GameEvent>& playTick(const Replay& replay, GameState& game, long long tick)
+{
+    uint8_t bits = replay.ticks[tick];
+    if (bits & REPLAY_RESTART)
+    {
+        restartLevel(game);
+    }
+    return step(game, replayInput(bits));
+}
+bool seekReplay(const Replay& replay, GameState& game, long long tick)
+{
+    if (tick < 0 || tick > static_cast<long long>(replay.ticks.size()))
+    {
+        return false;
+    }
+    // Last keyframe at or before the tick (keyframes are in tick order)
+    auto after = upper_bound(replay.keyframes.begin(), replay.keyframes.end(), tick,
+                             [](long long t, const Keyframe& keyframe) { return t < keyframe.tick; });
+    long long from = 0;
+    if (!startPlayback(replay, game))
+    {
+        return false;
+    }
+    if (after != replay.keyframes.begin())
+    {
+        const Keyframe& keyframe = *prev(after);
+        if (!loadState(game, keyframe.state.data(), keyframe.state.size()))
+        {
+            return false;
+        }
+        from = keyframe.tick;
+    }
+    for (long long t = from; t < tick; t++)
+    {
+        playTick(replay, game, t);
+    }
+    game.events.clear();
+    return true;
+}
+bool rebuildKeyframes(Replay& replay, GameState& game, int keyframeInterval)
+{
+    replay.keyframeInterval = keyframeInterval;
+    replay.keyframes.clear();
+    if (!startPlayback(replay, game))
+    {
+        return false;
+    }
+    long long tickCount = static_cast<long long>(replay.ticks.size());
+    for (long long tick = 0; tick < tickCount; tick++)
+    {
+        if (keyframeDue(replay, tick, (replay.ticks[tick] & REPLAY_RESTART) != 0))
+        {
+            addKeyframe(replay, game, tick);
+        }
+        playTick(replay, game, tick);
+    }
+    return true;
+}
+void encodeReplay(const Replay& replay, vector<uint8_t>& bytes)
+{
+    bytes.assign(REPLAY_MAGIC, REPLAY_MAGIC + 4);
+    putUint(bytes, REPLAY_VERSION, 4);
+    putUint(bytes, replay.seed, 8);
+    putUint(bytes, replay.rows, 4);
+    putUint(bytes, replay.cols, 4);
+    putUint(bytes, replay.lives, 4);
+    putUint(bytes, replay.score, 4);
+    putUint(bytes, replay.level, 4);
+    putUint(bytes, replay.ticks.size(), 8);
+    // Runs of identical input: the input byte, then how many ticks it lasts
+    size_t i = 0;
+    while (i < replay.ticks.size())
+    {
+        size_t run = 1;
+        while (i + run < replay.ticks.size() && replay.ticks[i + run] == replay.ticks[i])
+        {
+            run++;
+        }
+        bytes.push_back(replay.ticks[i]);
+        putVarint(bytes, run);
+        i += run;
+    }
+    // Keyframes after the input, so a reader that only wants the input can stop early
+    putUint(bytes, replay.keyframeInterval, 4);
+    putVarint(bytes, replay.keyframes.size());
+    for (size_t k = 0; k < replay.keyframes.size(); k++)
+    {
+        putVarint(bytes, replay.keyframes[k].tick);
+        putVarint(bytes, replay.keyframes[k].state.size());
+        bytes.insert(bytes.end(), replay.keyframes[k].state.begin(), replay.keyframes[k].state.end());
+    }
+    putVarint(bytes, replay.startState.size());
+    bytes.insert(bytes.end(), replay.startState.begin(), replay.startState.end());
+}
+bool saveReplay(const Replay& replay, const char path[])
+{
+    vector<uint8_t> bytes;
+    encodeReplay(replay, bytes);
+    ofstream file(path, ios::binary);
+    if (!file.is_open())
+    {
+        cerr << "Failed to write replay " << path << endl;
+        return false;
+    }
+    file.write(reinterpret_cast<const char*>(bytes.data()), bytes.size());
+    return file.good();
+}
+bool loadReplay(Replay& replay, const char path[])
+{
+    ifstream file(path, ios::binary);
+    if (!file.is_open())
+    {
+        cerr << "Failed to open replay " << path << endl;
+        return false;
+    }
+    vector<uint8_t> bytes((istreambuf_iterator<char>(file)), istreambuf_iterator<char>());
+    ByteReader reader = {bytes.data(), bytes.size(), 0};
+    uint64_t version, rows, cols, lives, score, level, tickCount;
+    if (bytes.size() < 4 || !equal(bytes.begin(), bytes.begin() + 4, REPLAY_MAGIC))
+    {
+        cerr << path << " is not a replay" << endl;
+        return false;
+    }
+    reader.pos = 4;
+    if (!getUint(reader, version, 4) || version != REPLAY_VERSION ||
+        !getUint(reader, replay.seed, 8) ||
+        !getUint(reader, rows, 4) || !getUint(reader, cols, 4) ||
+        !getUint(reader, lives, 4) || !getUint(reader, score, 4) || !getUint(reader, level, 4) ||
+        !getUint(reader, tickCount, 8))
+    {
+        cerr << path << " is not a replay this version can read" << endl;
+        return false;
+    }
+    // Sizes are checked before anything is allocated for them
+    if (!validBoardSize(static_cast<long long>(rows), static_cast<long long>(cols)))
+    {
+        cerr << "Replay " << path << " has a bad board size" << endl;
+        return false;
+    }
+    if (tickCount > static_cast<uint64_t>(MAX_REPLAY_TICKS))
+    {
+        cerr << "Replay " << path << " is longer than " << MAX_REPLAY_TICKS << " ticks" << endl;
+        return false;
+    }
+    replay.rows = static_cast<int>(rows);
+    replay.cols = static_cast<int>(cols);
+    replay.lives = static_cast<int>(lives);
+    replay.score = static_cast<int>(score);
+    replay.level = static_cast<int>(level);
+    replay.ticks.clear();
+    while (replay.ticks.size() < tickCount)
+    {
+        uint64_t bits, run;
+        if (!getUint(reader, bits, 1) || !getVarint(reader, run) || run > tickCount - replay.ticks.size())
+        {
+            cerr << "Replay " << path << " is cut short" << endl;
+            return false;
+        }
+        replay.ticks.insert(replay.ticks.end(), run, static_cast<uint8_t>(bits));
+    }
+    replay.keyframes.clear();
+    uint64_t interval, keyframeCount;
+    if (!getUint(reader, interval, 4) || !getVarint(reader, keyframeCount))
+    {
+        cerr << "Replay " << path << " is cut short" << endl;
+        return false;
+    }
+    replay.keyframeInterval = static_cast<int>(interval);
+    for (uint64_t k = 0; k < keyframeCount; k++)
+    {
+        uint64_t tick, size;
+        if (!getVarint(reader, tick) || !getVarint(reader, size) || size > reader.size - reader.pos)
+        {
+            cerr << "Replay " << path << " is cut short" << endl;
+            return false;
+        }
+        bool outOfOrder = !replay.keyframes.empty() && static_cast<long long>(tick) <= replay.keyframes.back().tick;
+        if (tick > tickCount || outOfOrder)
+        {
+            cerr << "Replay " << path << " has keyframes out of order" << endl;
+            return false;
+        }
+        Keyframe keyframe;
+        keyframe.tick = static_cast<long long>(tick);
+        keyframe.state.assign(bytes.begin() + reader.pos, bytes.begin() + reader.pos + size);
+        reader.pos += size;
+        replay.keyframes.push_back(keyframe);
+    }
+    uint64_t startSize;
+    if (!getVarint(reader, startSize) || startSize > reader.size - reader.pos)
+    {
+        cerr << "Replay " << path << " is cut short" << endl;
+        return false;
+    }
+    replay.startState.assign(bytes.begin() + reader.pos, bytes.begin() + reader.pos + startSize);
+    return true;
+}
+// FNV-1a over the saveState bytes: everything that decides what happens next, pool order included (it decides
+// the order collisions resolve in), to compare two runs without a debugger
+uint64_t stateChecksum(const GameState& game)
+{
+    vector<uint8_t> state;
+    saveState(game, state);
+    return fnv1a(state.data(), state.size());
+}
@@ -0,0 +1,57 @@
+// Input recording and replay
+// A game is fully decided by its seed, its starting lives/score/level and the input given to every tick,
+// so that is all a recording holds. Playing it back re-runs step() with the same inputs and ends up in
+// exactly the same state, at whatever speed the caller likes.
+// Recordings also carry a full state keyframe every so many ticks, so seeking only has to re-simulate from
+// the keyframe before the target tick, however long the recording is.
+#pragma once
+#include <cstdint>
+#include <vector>
+#include "simulation.h"
+// One byte of input per tick
+const uint8_t REPLAY_LEFT = 1;
+const uint8_t REPLAY_RIGHT = 2;
+const uint8_t REPLAY_FIRE = 4;
+const uint8_t REPLAY_RESTART = 8; // restartLevel() right before this tick (pause menu restart)
+const uint32_t REPLAY_VERSION = 1;
+const long long MAX_REPLAY_TICKS = 24LL * 3600 * 240; // a day of game time, longer files are refused
+const int DEFAULT_KEYFRAME_INTERVAL = 30 * 240; // 30 s of game time: at most 7200 ticks to re-simulate per seek
+struct Keyframe
+{
+    long long tick;             // state right before this tick is played
+    std::vector<uint8_t> state; // saveState() bytes
+};
+struct Replay
+{
+    uint64_t seed;
+    int rows;
+    int cols;
+    int lives; // what newGame() was called with
+    int score;
+    int level;
+    std::vector<uint8_t> ticks; // input for every tick, in order
+    int keyframeInterval;       // ticks between keyframes (0 = none: bigger files, slower seeks)
+    std::vector<Keyframe> keyframes;
+    std::vector<uint8_t> startState; // saveState() bytes for games resumed from a save (empty: seed + newGame)
+};
+// Recording: startRecording sets up the game and the replay together, then recordTick before every step()
+void startRecording(Replay& replay, GameState& game, uint64_t seed, int lives, int score, int level,
+                    int keyframeInterval);
+void resumeRecording(Replay& replay, const GameState& game, int keyframeInterval); // from a loaded save
+void recordTick(Replay& replay, const GameState& game, const Input& input, bool restart);
+// Playback: startPlayback puts the game where the recording started (false if its start state is damaged),
+// playTick runs one recorded tick
+bool startPlayback(const Replay& replay, GameState& game);
+const std::vector<GameEvent>& playTick(const Replay& replay, GameState& game, long long tick);
+// Seeking: puts the game right before the given tick (0 .. ticks.size()), continue with playTick(tick)
+bool seekReplay(const Replay& replay, GameState& game, long long tick);
+// Replace the keyframes with new ones every keyframeInterval ticks, by playing the recording through
+bool rebuildKeyframes(Replay& replay, GameState& game, int keyframeInterval);
+Input replayInput(uint8_t bits);
+// Files store the inputs run-length encoded (held keys repeat for hundreds of ticks). encodeReplay gives the
+// file's bytes, to write them elsewhere (the game queues them on the save writer, savegame.h).
+void encodeReplay(const Replay& replay, std::vector<uint8_t>& bytes);
+bool saveReplay(const Replay& replay, const char path[]);
+bool loadReplay(Replay& replay, const char path[]);
+// Hash of the gameplay state: two runs that agree on it are in the same place
+uint64_t stateChecksum(const GameState& game);
@@ -0,0 +1,427 @@
+#include "savegame.h"
+#include "snapshot.h"
+#include "bytes.h"
+#include <algorithm>
+#include <condition_variable>
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <mutex>
+#include <string>
+#include <thread>
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+using namespace std;
+const char SAVE_MAGIC[4] = {'S', 'S', 'S', 'V'};
+const int SAVE_HEADER_SIZE = 4 + 4 + 8 + 8; // magic, version, payload size, checksum
+const char HIGH_SCORE_FILE[] = "high-score.sav";
+const char OLD_SAVE_FILE[] = "save-file.txt"; // text save from before slots: "highScore lives score level"
+string slotPath(int slot)
+{
+    return "save-slot-" + to_string(slot + 1) + ".sav";
+}
+bool slotUsed[SAVE_SLOTS]; // see scanSaveSlots
+// Background writer: one pending write per file, newest payload wins
+struct PendingWrite
+{
+    string path;
+    vector<uint8_t> payload;
+    bool remove; // delete the file instead
+    bool raw;    // payload is the whole file, no save header (queueFile)
+};
+struct SaveWorker
+{
+    thread writer;
+    mutex lock;
+    condition_variable wake; // something was queued
+    condition_variable idle; // queue drained and nothing being written
+    vector<PendingWrite> pending;
+    PendingWrite current;    // taken by the writer, being written now
+    bool busy;
+    bool stopping;
+    ~SaveWorker();
+};
+SaveWorker saveWorker;
+// Queued or in-flight write for a file, if any (called with the lock held)
+const PendingWrite* findPendingWrite(const string& path)
+{
+    for (size_t i = 0; i < saveWorker.pending.size(); i++)
+    {
+        if (saveWorker.pending[i].path == path)
+        {
+            return &saveWorker.pending[i];
+        }
+    }
+    if (saveWorker.busy && saveWorker.current.path == path)
+    {
+        return &saveWorker.current;
+    }
+    return nullptr;
+}
+// Catches torn or damaged files
+uint64_t payloadChecksum(const vector<uint8_t>& payload)
+{
+    return fnv1a(payload.data(), payload.size());
+}
+// Whole file, atomically: temp file, synced, renamed over the old one
+bool writeFileAtomic(const char path[], const vector<uint8_t>& bytes)
+{
+    string tempPath = string(path) + ".tmp";
+    // The temp file has to be on the disk before it replaces the old one, and the rename has to be on the
+    // disk before we call the save done, or a power cut can leave an empty file behind
+#ifdef _WIN32
+    HANDLE file = CreateFileA(tempPath.c_str(), GENERIC_WRITE, 0, NULL, CREATE_ALWAYS, FILE_ATTRIBUTE_NORMAL, NULL);
+    if (file == INVALID_HANDLE_VALUE)
+    {
+        cerr << "Failed to write " << tempPath << endl;
+        return false;
+    }
+    DWORD written = 0;
+    bool ok = WriteFile(file, bytes.data(), static_cast<DWORD>(bytes.size()), &written, NULL) &&
+              written == bytes.size() && FlushFileBuffers(file);
+    CloseHandle(file);
+    if (!ok)
+    {
+        cerr << "Failed to write " << tempPath << endl;
+        return false;
+    }
+    if (!MoveFileExA(tempPath.c_str(), path, MOVEFILE_REPLACE_EXISTING | MOVEFILE_WRITE_THROUGH))
+    {
+        cerr << "Failed to replace " << path << endl;
+        return false;
+    }
+#else
+    int file = open(tempPath.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    if (file < 0)
+    {
+        cerr << "Failed to write " << tempPath << endl;
+        return false;
+    }
+    size_t done = 0;
+    while (done < bytes.size())
+    {
+        ssize_t written = write(file, bytes.data() + done, bytes.size() - done);
+        if (written <= 0)
+        {
+            break;
+        }
+        done += static_cast<size_t>(written);
+    }
+    bool ok = done == bytes.size() && fsync(file) == 0;
+    close(file);
+    if (!ok)
+    {
+        cerr << "Failed to write " << tempPath << endl;
+        return false;
+    }
+    if (rename(tempPath.c_str(), path) != 0)
+    {
+        cerr << "Failed to replace " << path << endl;
+        return false;
+    }
+    string folder = filesystem::path(path).parent_path().string();
+    int dir = open(folder.empty() ? "." : folder.c_str(), O_RDONLY);
+    if (dir >= 0) // the new directory entry
+    {
+        fsync(dir);
+        close(dir);
+    }
+#endif
+    return true;
+}
+bool writeSaveFile(const char path[], const vector<uint8_t>& payload)
+{
+    vector<uint8_t> bytes(SAVE_MAGIC, SAVE_MAGIC + 4); // header, then the payload
+    putUint(bytes, SAVE_VERSION, 4);
+    putUint(bytes, payload.size(), 8);
+    putUint(bytes, payloadChecksum(payload), 8);
+    bytes.insert(bytes.end(), payload.begin(), payload.end());
+    return writeFileAtomic(path, bytes);
+}
+bool readSaveFile(const char path[], vector<uint8_t>& payload)
+{
+    {
+        lock_guard<mutex> guard(saveWorker.lock);
+        const PendingWrite* write = findPendingWrite(path);
+        if (write != nullptr) // not on disk yet, but it will be
+        {
+            payload = write->payload;
+            return !write->remove;
+        }
+    }
+    ifstream file(path, ios::binary);
+    if (!file.is_open())
+    {
+        return false;
+    }
+    vector<uint8_t> bytes((istreambuf_iterator<char>(file)), istreambuf_iterator<char>());
+    ByteReader reader = {bytes.data(), bytes.size(), 4};
+    uint64_t version, size, checksum;
+    if (bytes.size() < SAVE_HEADER_SIZE || !equal(bytes.begin(), bytes.begin() + 4, SAVE_MAGIC) ||
+        !getUint(reader, version, 4) || !getUint(reader, size, 8) || !getUint(reader, checksum, 8))
+    {
+        cerr << path << " is not a save file" << endl;
+        return false;
+    }
+    if (version != SAVE_VERSION)
+    {
+        cerr << path << " was saved by a different version of the game" << endl;
+        return false;
+    }
+    payload.assign(bytes.begin() + SAVE_HEADER_SIZE, bytes.end());
+    if (payload.size() != size || payloadChecksum(payload) != checksum)
+    {
+        cerr << path << " is damaged" << endl;
+        return false;
+    }
+    return true;
+}
+// Slot payload: the summary, then the game state
+void gamePayload(const GameState& game, vector<uint8_t>& payload)
+{
+    vector<uint8_t> state;
+    saveState(game, state);
+    payload.clear();
+    putUint(payload, game.rows, 4);
+    putUint(payload, game.cols, 4);
+    putUint(payload, game.lives, 4);
+    putUint(payload, game.score, 4);
+    putUint(payload, game.level, 4);
+    payload.insert(payload.end(), state.begin(), state.end());
+}
+bool saveGame(const GameState& game, int slot)
+{
+    vector<uint8_t> payload;
+    gamePayload(game, payload);
+    bool saved = writeSaveFile(slotPath(slot).c_str(), payload);
+    slotUsed[slot] = slotUsed[slot] || saved;
+    return saved;
+}
+bool readSummary(ByteReader& reader, SaveSummary& summary)
+{
+    uint64_t values[5];
+    for (int i = 0; i < 5; i++)
+    {
+        if (!getUint(reader, values[i], 4))
+        {
+            return false;
+        }
+    }
+    summary.rows = static_cast<int>(values[0]);
+    summary.cols = static_cast<int>(values[1]);
+    summary.lives = static_cast<int>(values[2]);
+    summary.score = static_cast<int>(values[3]);
+    summary.level = static_cast<int>(values[4]);
+    return true;
+}
+bool loadGame(GameState& game, int slot)
+{
+    vector<uint8_t> payload;
+    if (!readSaveFile(slotPath(slot).c_str(), payload))
+    {
+        return false;
+    }
+    ByteReader reader = {payload.data(), payload.size(), 0};
+    SaveSummary summary;
+    if (!readSummary(reader, summary))
+    {
+        return false;
+    }
+    if (summary.rows != game.rows || summary.cols != game.cols)
+    {
+        cerr << "Slot " << slot + 1 << " was saved on a " << summary.rows << "x" << summary.cols << " board" << endl;
+        return false;
+    }
+    return loadState(game, payload.data() + reader.pos, payload.size() - reader.pos);
+}
+bool readSaveSummary(int slot, SaveSummary& summary)
+{
+    vector<uint8_t> payload;
+    if (!readSaveFile(slotPath(slot).c_str(), payload))
+    {
+        return false;
+    }
+    ByteReader reader = {payload.data(), payload.size(), 0};
+    return readSummary(reader, summary);
+}
+void deleteSave(int slot)
+{
+    remove(slotPath(slot).c_str());
+    slotUsed[slot] = false;
+}
+void scanSaveSlots()
+{
+    SaveSummary summary;
+    for (int slot = 0; slot < SAVE_SLOTS; slot++)
+    {
+        slotUsed[slot] = readSaveSummary(slot, summary);
+    }
+}
+bool slotInUse(int slot)
+{
+    return slotUsed[slot];
+}
+void highScorePayload(int highScore, vector<uint8_t>& payload)
+{
+    payload.clear();
+    putUint(payload, static_cast<uint32_t>(highScore), 4);
+}
+bool saveHighScore(int highScore)
+{
+    vector<uint8_t> payload;
+    highScorePayload(highScore, payload);
+    return writeSaveFile(HIGH_SCORE_FILE, payload);
+}
+int loadHighScore()
+{
+    vector<uint8_t> payload;
+    if (readSaveFile(HIGH_SCORE_FILE, payload))
+    {
+        ByteReader reader = {payload.data(), payload.size(), 0};
+        uint64_t highScore;
+        if (getUint(reader, highScore, 4))
+        {
+            return static_cast<int>(highScore);
+        }
+    }
+    return 0;
+}
+bool migrateOldSave(GameState& game, uint64_t seed)
+{
+    int highScore = 0, lives = 0, score = 0, level = 0;
+    ifstream oldFile(OLD_SAVE_FILE);
+    if (!oldFile.is_open() || !(oldFile >> highScore))
+    {
+        return false;
+    }
+    oldFile >> lives >> score >> level; // only the high score if these are missing
+    oldFile.close();
+    bool saved = true;
+    if (highScore > loadHighScore())
+    {
+        saved = saveHighScore(highScore);
+    }
+    SaveSummary summary;
+    if (lives > 0 && level > 0 && !readSaveSummary(0, summary)) // the old save kept the level, not the board
+    {
+        seedGame(game, seed);
+        newGame(game, lives, score, level);
+        saved = saveGame(game, 0) && saved;
+    }
+    if (!saved) // try again next time
+    {
+        return false;
+    }
+    string donePath = string(OLD_SAVE_FILE) + ".old";
+    remove(donePath.c_str());
+    rename(OLD_SAVE_FILE, donePath.c_str());
+    return true;
+}
+void writerLoop()
+{
+    unique_lock<mutex> guard(saveWorker.lock);
+    while (true)
+    {
+        saveWorker.wake.wait(guard, [] { return saveWorker.stopping || !saveWorker.pending.empty(); });
+        if (saveWorker.pending.empty()) // stopping, and everything is written
+        {
+            return;
+        }
+        saveWorker.current = saveWorker.pending.front();
+        saveWorker.pending.erase(saveWorker.pending.begin());
+        saveWorker.busy = true;
+        guard.unlock();
+        if (saveWorker.current.remove)
+        {
+            remove(saveWorker.current.path.c_str());
+        }
+        else if (saveWorker.current.raw)
+        {
+            writeFileAtomic(saveWorker.current.path.c_str(), saveWorker.current.payload);
+        }
+        else
+        {
+            writeSaveFile(saveWorker.current.path.c_str(), saveWorker.current.payload);
+        }
+        guard.lock();
+        saveWorker.busy = false;
+        if (saveWorker.pending.empty())
+        {
+            saveWorker.idle.notify_all();
+        }
+    }
+}
+void queueWrite(const string& path, vector<uint8_t>& payload, bool remove, bool raw)
+{
+    {
+        lock_guard<mutex> guard(saveWorker.lock);
+        if (!saveWorker.writer.joinable()) // started by the first write
+        {
+            saveWorker.writer = thread(writerLoop);
+        }
+        PendingWrite* write = nullptr;
+        for (size_t i = 0; i < saveWorker.pending.size(); i++)
+        {
+            if (saveWorker.pending[i].path == path)
+            {
+                write = &saveWorker.pending[i]; // not started yet, just replace what it writes
+            }
+        }
+        if (write == nullptr)
+        {
+            saveWorker.pending.push_back(PendingWrite());
+            write = &saveWorker.pending.back();
+            write->path = path;
+        }
+        write->payload.swap(payload);
+        write->remove = remove;
+        write->raw = raw;
+    }
+    saveWorker.wake.notify_one();
+}
+void queueSave(const GameState& game, int slot)
+{
+    vector<uint8_t> payload;
+    gamePayload(game, payload);
+    queueWrite(slotPath(slot), payload, false, false);
+    slotUsed[slot] = true;
+}
+void queueDeleteSave(int slot)
+{
+    vector<uint8_t> payload;
+    queueWrite(slotPath(slot), payload, true, false);
+    slotUsed[slot] = false;
+}
+void queueHighScore(int highScore)
+{
+    vector<uint8_t> payload;
+    highScorePayload(highScore, payload);
+    queueWrite(HIGH_SCORE_FILE, payload, false, false);
+}
+void queueFile(const char path[], vector<uint8_t>& bytes)
+{
+    queueWrite(path, bytes, false, true);
+}
+void flushSaves()
+{
+    unique_lock<mutex> guard(saveWorker.lock);
+    saveWorker.idle.wait(guard, [] { return saveWorker.pending.empty() && !saveWorker.busy; });
+}
+SaveWorker::~SaveWorker()
+{
+    {
+        lock_guard<mutex> guard(lock);
+        stopping = true;
+    }
+    wake.notify_all();
+    if (writer.joinable())
+    {
+        writer.join(); // the writer drains the queue before it stops
+    }
+}
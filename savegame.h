@@ -0,0 +1,47 @@
+// Save games and the high score
+// Every save is a versioned binary file: a small header with the payload size and a checksum, then the
+// payload. Saves hold the complete game state (snapshot.h), so a loaded game carries on from the exact tick
+// it was saved on. Files are written to a temp file, synced to disk and renamed over the old one, and the
+// rename is synced too, so a crash or power cut mid-save leaves the previous save in place.
+// The game loop queues its writes instead (queueSave and friends): the state is copied into a payload
+// straight away and a background thread does the file work, so a slow disk never stalls a frame.
+#pragma once
+#include <cstdint>
+#include <vector>
+#include "simulation.h"
+const int SAVE_SLOTS = 3;
+const uint32_t SAVE_VERSION = 1;
+// What the slot menu shows without loading the whole game
+struct SaveSummary
+{
+    int rows;
+    int cols;
+    int lives;
+    int score;
+    int level;
+};
+// Raw files: false if the file is missing, damaged (checksum) or from another version
+bool writeSaveFile(const char path[], const std::vector<uint8_t>& payload);
+bool readSaveFile(const char path[], std::vector<uint8_t>& payload);
+// Slots 0 .. SAVE_SLOTS - 1
+bool saveGame(const GameState& game, int slot);
+bool loadGame(GameState& game, int slot); // game must be set up for the board size the save was made on
+bool readSaveSummary(int slot, SaveSummary& summary);
+void deleteSave(int slot);
+// Which slots hold a game: read from the files once by scanSaveSlots (at startup), then kept up to date by
+// every save and delete, queued or not, so the game loop never has to read the slot files to find out
+void scanSaveSlots();
+bool slotInUse(int slot);
+bool saveHighScore(int highScore);
+int loadHighScore(); // 0 if there is none yet
+// The text save-file.txt from before slots: its high score is kept and its game goes into slot 0 (unless
+// that is taken), starting the saved level over like the old Continue did. The file is renamed to
+// save-file.txt.old afterwards. True if there was one; game is left on the migrated game.
+bool migrateOldSave(GameState& game, uint64_t seed);
+// Background writes: a newer write to a file replaces one still waiting, and reads above already see
+// queued writes. Everything queued is written before the program exits (or when flushSaves returns).
+void queueSave(const GameState& game, int slot);
+void queueDeleteSave(int slot);
+void queueHighScore(int highScore);
+void queueFile(const char path[], std::vector<uint8_t>& bytes); // any other file, written as is (replays)
+void flushSaves();
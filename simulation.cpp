@@ -0,0 +1,1009 @@
+#include "simulation.h"
+#include "profiler.h"
+#include <algorithm>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+// Helper functions:
+void addEvent(GameState& game, int type, int row, int col, int value)
+{
+    GameEvent event;
+    event.type = type;
+    event.row = row;
+    event.col = col;
+    event.value = value;
+    game.events.push_back(event);
+}
+void createExplosionEffect(GameState& game, int row, int col)
+{
+    addEvent(game, EVENT_EXPLOSION, row, col, 0);
+    HitEffectPool& effects = game.hitEffects;
+    if (static_cast<int>(effects.row.size()) >= effects.capacity)
+    {
+        effects.overflow++;
+        return;
+    }
+    effects.row.push_back(row);
+    effects.col.push_back(col);
+    effects.timer.push_back(0.0f);
+}
+void removeHitEffect(HitEffectPool& effects, size_t i)
+{
+    effects.row[i] = effects.row.back();
+    effects.col[i] = effects.col.back();
+    effects.timer[i] = effects.timer.back();
+    effects.row.pop_back();
+    effects.col.pop_back();
+    effects.timer.pop_back();
+}
+// Entity pools
+EntityPool& poolAt(GameState& game, int code, int col)
+{
+    return game.bands[col / game.bandCols].pools[code - 2];
+}
+void addEntity(GameState& game, int code, int row, int col)
+{
+    EntityPool& pool = poolAt(game, code, col);
+    game.grid[row][col] = code;
+    game.slot[row][col] = static_cast<int>(pool.row.size());
+    pool.row.push_back(row);
+    pool.col.push_back(col);
+    pool.prevRow.push_back(row); // new ones appear in place
+}
+void removeEntity(GameState& game, int row, int col)
+{
+    EntityPool& pool = poolAt(game, game.grid[row][col], col);
+    int i = game.slot[row][col];
+    pool.row[i] = pool.row.back(); // last entity takes its place
+    pool.col[i] = pool.col.back();
+    pool.prevRow[i] = pool.prevRow.back();
+    pool.row.pop_back();
+    pool.col.pop_back();
+    pool.prevRow.pop_back();
+    if (i < static_cast<int>(pool.row.size()))
+    {
+        game.slot[pool.row[i]][pool.col[i]] = i;
+    }
+    game.grid[row][col] = 0;
+}
+void clearPools(GameState& game)
+{
+    for (size_t b = 0; b < game.bands.size(); b++)
+    {
+        for (int p = 0; p < POOL_COUNT; p++)
+        {
+            game.bands[b].pools[p].row.clear();
+            game.bands[b].pools[p].col.clear();
+            game.bands[b].pools[p].prevRow.clear();
+        }
+    }
+}
+void rebuildPools(GameState& game)
+{
+    clearPools(game);
+    for (int r = 0; r < game.rows; r++)
+    {
+        for (int c = 0; c < game.cols; c++)
+        {
+            if (game.grid[r][c] >= 2 && game.grid[r][c] <= 6)
+            {
+                addEntity(game, game.grid[r][c], r, c);
+            }
+        }
+    }
+}
+// Take a whole pool off the grid before moving it, so every entity sees the cell ahead as it was
+// before the pass (same result as the old bottom-to-top sweep). Where they were is kept to draw them
+// gliding away from it.
+void liftPool(GameState& game, EntityPool& pool)
+{
+    pool.prevRow = pool.row;
+    for (size_t i = 0; i < pool.row.size(); i++)
+    {
+        game.grid[pool.row[i]][pool.col[i]] = 0;
+    }
+}
+// Put the pool back on the grid at its new positions, dropping the entities marked dead (row -1)
+void settlePool(GameState& game, EntityPool& pool, int code)
+{
+    int alive = 0;
+    for (size_t i = 0; i < pool.row.size(); i++)
+    {
+        if (pool.row[i] >= 0)
+        {
+            pool.row[alive] = pool.row[i];
+            pool.col[alive] = pool.col[i];
+            pool.prevRow[alive] = pool.prevRow[i];
+            game.grid[pool.row[alive]][pool.col[alive]] = code;
+            game.slot[pool.row[alive]][pool.col[alive]] = alive;
+            alive++;
+        }
+    }
+    pool.row.resize(alive);
+    pool.col.resize(alive);
+    pool.prevRow.resize(alive);
+}
+void clearGrid(GameState& game)
+{
+    for (int r = 0; r < game.rows; r++)
+    {
+        for (int c = 0; c < game.cols; c++)
+        {
+            game.grid[r][c] = 0;
+        }
+    }
+    clearPools(game);
+}
+void clearEntities(GameState& game)
+{
+    for (size_t b = 0; b < game.bands.size(); b++)
+    {
+        for (int p = 0; p < POOL_COUNT; p++)
+        {
+            EntityPool& pool = game.bands[b].pools[p];
+            for (size_t i = 0; i < pool.row.size(); i++)
+            {
+                game.grid[pool.row[i]][pool.col[i]] = 0;
+            }
+        }
+    }
+    clearPools(game);
+}
+// Worker threads for the column bands. Each pass hands out its bands to the workers and the calling
+// thread, and returns once every band is done.
+struct BandWorkers
+{
+    std::vector<std::thread> threads;
+    std::mutex mutex;
+    std::condition_variable wake;     // a new pass is ready
+    std::condition_variable finished; // last band of the pass is done
+    void (*job)(GameState&, int);
+    GameState* game;
+    int bandCount;
+    int nextBand;
+    int bandsLeft;
+    int generation;                   // bumped for every pass, so workers can tell a new one from the old
+    bool stopping;
+    ~BandWorkers();
+};
+BandWorkers workers;
+// Take bands until there are none left (called with the lock held)
+void runPendingBands(std::unique_lock<std::mutex>& lock)
+{
+    while (workers.nextBand < workers.bandCount)
+    {
+        int band = workers.nextBand++;
+        lock.unlock();
+        workers.job(*workers.game, band);
+        lock.lock();
+        workers.bandsLeft--;
+        if (workers.bandsLeft == 0)
+        {
+            workers.finished.notify_all();
+        }
+    }
+}
+void workerLoop()
+{
+    std::unique_lock<std::mutex> lock(workers.mutex);
+    int seen = workers.generation;
+    while (true)
+    {
+        workers.wake.wait(lock, [&seen] { return workers.stopping || workers.generation != seen; });
+        if (workers.stopping)
+        {
+            return;
+        }
+        seen = workers.generation;
+        runPendingBands(lock);
+    }
+}
+void stopWorkers()
+{
+    {
+        std::lock_guard<std::mutex> lock(workers.mutex);
+        workers.stopping = true;
+    }
+    workers.wake.notify_all();
+    for (size_t i = 0; i < workers.threads.size(); i++)
+    {
+        workers.threads[i].join();
+    }
+    workers.threads.clear();
+    workers.stopping = false;
+}
+BandWorkers::~BandWorkers()
+{
+    stopWorkers();
+}
+void setSimulationThreads(int threads)
+{
+    if (threads < 1)
+        threads = 1;
+    stopWorkers();
+    for (int i = 1; i < threads; i++) // the thread calling step() does its share too
+    {
+        workers.threads.push_back(std::thread(workerLoop));
+    }
+}
+// Run a band pass over every band of the board
+void runBands(GameState& game, void (*job)(GameState&, int))
+{
+    int bandCount = static_cast<int>(game.bands.size());
+    if (bandCount == 1 || workers.threads.empty())
+    {
+        for (int b = 0; b < bandCount; b++)
+        {
+            job(game, b);
+        }
+        return;
+    }
+    std::unique_lock<std::mutex> lock(workers.mutex);
+    workers.job = job;
+    workers.game = &game;
+    workers.bandCount = bandCount;
+    workers.nextBand = 0;
+    workers.bandsLeft = bandCount;
+    workers.generation++;
+    workers.wake.notify_all();
+    runPendingBands(lock);
+    workers.finished.wait(lock, [] { return workers.bandsLeft == 0; });
+}
+void addCollision(std::vector<Collision>& collisions, int type, int row, int col)
+{
+    Collision collision;
+    collision.type = type;
+    collision.row = row;
+    collision.col = col;
+    collisions.push_back(collision);
+}
+// Queue what the bands ran into during a pass for the end of the tick, band by band and in the order each
+// band found them
+void gatherCollisions(GameState& game)
+{
+    for (size_t b = 0; b < game.bands.size(); b++)
+    {
+        std::vector<Collision>& collisions = game.bands[b].collisions;
+        game.collisions.insert(game.collisions.end(), collisions.begin(), collisions.end());
+        collisions.clear();
+    }
+}
+void resetSpaceship(GameState& game)
+{
+    game.grid[game.rows - 1][game.spaceshipCol] = 0;
+    game.spaceshipCol = game.cols / 2;
+    game.grid[game.rows - 1][game.spaceshipCol] = 1;
+}
+void resetTimers(float timers[])
+{
+    for (int i = 0; i < TIMER_COUNT; i++)
+    {
+        timers[i] = 0.0f;
+    }
+    timers[TIMER_PLAYER_MOVE] = MOVE_COOLDOWN;       // player can move and shoot straight away
+    timers[TIMER_BULLET_FIRE] = BULLET_FIRE_COOLDOWN;
+}
+void advanceTimers(float timers[])
+{
+    for (int i = 0; i < TIMER_COUNT; i++)
+    {
+        if (i != TIMER_PLAYER_MOVE && i != TIMER_BULLET_FIRE) // cooldowns are advanced by cooldownReady
+        {
+            timers[i] += TICK_DT;
+        }
+    }
+}
+bool cooldownReady(float timers[], int timer, float cooldown)
+{
+    if (timers[timer] < cooldown) // idle time does not pile up past one cooldown
+    {
+        timers[timer] += TICK_DT;
+    }
+    return timers[timer] >= cooldown;
+}
+// Player got hit by something: the shield absorbs it, otherwise a life is lost (ignored while invincible).
+// A shield blows up whatever crashed into it (explosion sound), a meteor just takes the shield down.
+void damagePlayer(GameState& game, bool crash)
+{
+    if (game.hasShield)
+    {
+        game.hasShield = false;
+        game.isInvincible = true;
+        game.timers[TIMER_INVINCIBILITY] = 0.0f; // 2s invincibility
+        addEvent(game, EVENT_PLAYER_HIT, game.rows - 1, game.spaceshipCol, crash ? 2 : 0);
+    }
+    else if (!game.isInvincible)
+    {
+        game.lives--;
+        game.isInvincible = true;
+        game.timers[TIMER_INVINCIBILITY] = 0.0f;
+        addEvent(game, EVENT_PLAYER_HIT, game.rows - 1, game.spaceshipCol, 1);
+        if (game.lives <= 0) // game over
+        {
+            addEvent(game, EVENT_GAME_OVER, game.rows - 1, game.spaceshipCol, game.score);
+        }
+    }
+}
+// Something at (row, col) was shot down; enemies and bosses also count towards the next level
+// Returns true if that finished the level and cleared the board
+bool scoreHit(GameState& game, int row, int col, int points, bool countsAsKill)
+{
+    game.score += points;
+    createExplosionEffect(game, row, col);
+    addEvent(game, EVENT_KILL, row, col, points);
+    if (!countsAsKill)
+    {
+        return false;
+    }
+    game.killCount++; // +1 kill
+    // check if level up
+    int killsNeeded = game.level * 10;
+    if (game.level < MAX_LEVEL && game.killCount >= killsNeeded)
+    {
+        game.level++;
+        game.killCount = 0;
+        game.bossMoveCounter = 0;
+        clearEntities(game);
+        resetSpaceship(game);
+        resetTimers(game.timers); // next level starts with fresh timers
+        addEvent(game, EVENT_LEVEL_UP, row, col, game.level);
+        return true;
+    }
+    else if (game.level >= MAX_LEVEL && game.killCount >= killsNeeded)
+    {
+        addEvent(game, EVENT_VICTORY, row, col, game.score);
+    }
+    return false;
+}
+void resolveCollisions(GameState& game)
+{
+    bool boardCleared = false; // a level up wipes the board, nothing after it happened
+    bool ended = false;        // neither does anything after game over or victory
+    for (size_t i = 0; i < game.collisions.size() && !boardCleared && !ended; i++)
+    {
+        const Collision& hit = game.collisions[i];
+        size_t firstEvent = game.events.size();
+        if (hit.type == COLLISION_PLAYER || hit.type == COLLISION_PLAYER_CRASH)
+        {
+            damagePlayer(game, hit.type == COLLISION_PLAYER_CRASH);
+        }
+        else if (hit.type == COLLISION_PLAYER_BLAST)
+        {
+            damagePlayer(game, true);
+            createExplosionEffect(game, hit.row, hit.col);
+        }
+        else if (hit.type == COLLISION_METEOR_SHOT)
+        {
+            int meteorPoints = 1 + randomInt(game, RNG_METEOR_POINTS, 2); // Random 1-2 points
+            scoreHit(game, hit.row, hit.col, meteorPoints, false);
+        }
+        else if (hit.type == COLLISION_BOSS_BULLET_SHOT)
+        {
+            createExplosionEffect(game, hit.row, hit.col);
+            addEvent(game, EVENT_BULLET_HIT, hit.row, hit.col, 0);
+        }
+        else if (hit.type == COLLISION_ENEMY_SHOT)
+        {
+            boardCleared = scoreHit(game, hit.row, hit.col, 3, true); // 3 score
+        }
+        else if (hit.type == COLLISION_BOSS_SHOT)
+        {
+            boardCleared = scoreHit(game, hit.row, hit.col, 5, true); // 5 points
+        }
+        else if (hit.type == COLLISION_SHIELD_PICKUP && !game.hasShield)
+        {
+            game.hasShield = true;
+            addEvent(game, EVENT_SHIELD_PICKUP, hit.row, hit.col, 0);
+        }
+        for (size_t e = firstEvent; e < game.events.size(); e++)
+        {
+            ended = ended || game.events[e].type == EVENT_GAME_OVER || game.events[e].type == EVENT_VICTORY;
+        }
+    }
+}
+// Game setup
+bool validBoardSize(long long rows, long long cols)
+{
+    return rows >= MIN_ROWS && cols >= 1 && rows <= MAX_BOARD_CELLS && cols <= MAX_BOARD_CELLS / rows;
+}
+void setupBoard(GameState& game, int rows, int cols)
+{
+    game.rows = rows;
+    game.cols = cols;
+    game.grid.cols = cols;
+    game.grid.cells.assign(rows * cols, 0);
+    game.slot.cols = cols;
+    game.slot.cells.assign(rows * cols, 0);
+    // Bands depend on the board size only, never on the thread count, so every thread count plays the same game
+    int bandCount = rows * cols / MIN_BAND_CELLS;
+    if (bandCount > MAX_BANDS)
+        bandCount = MAX_BANDS;
+    if (bandCount > cols)
+        bandCount = cols;
+    if (bandCount < 1)
+        bandCount = 1;
+    game.bandCols = (cols + bandCount - 1) / bandCount;
+    game.bands.clear();
+    game.bands.resize((cols + game.bandCols - 1) / game.bandCols);
+    for (size_t b = 0; b < game.bands.size(); b++)
+    {
+        game.bands[b].firstCol = static_cast<int>(b) * game.bandCols;
+        game.bands[b].endCol = std::min(cols, game.bands[b].firstCol + game.bandCols);
+    }
+    game.spaceshipCol = cols / 2;
+    game.hitEffects.overflow = 0;
+    long long scaled = static_cast<long long>(DEFAULT_HIT_EFFECTS) * rows * cols / (DEFAULT_ROWS * DEFAULT_COLS);
+    setHitEffectCapacity(game, static_cast<int>(std::max<long long>(DEFAULT_HIT_EFFECTS, scaled)));
+    seedGame(game, 1); // until the caller picks a seed
+}
+void setHitEffectCapacity(GameState& game, int capacity)
+{
+    HitEffectPool& effects = game.hitEffects;
+    effects.capacity = std::max(capacity, 0);
+    while (static_cast<int>(effects.row.size()) > effects.capacity)
+    {
+        removeHitEffect(effects, effects.row.size() - 1);
+    }
+}
+// splitmix64: turns the seed into well spread states for the generators
+uint64_t mixSeed(uint64_t& x)
+{
+    x += 0x9E3779B97F4A7C15ull;
+    uint64_t z = x;
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+    return z ^ (z >> 31);
+}
+void seedGame(GameState& game, uint64_t seed)
+{
+    for (int i = 0; i < RNG_COUNT; i++)
+    {
+        game.rng[i] = mixSeed(seed) | 1; // xorshift must never be all zeros
+    }
+}
+// xorshift64*
+int randomInt(GameState& game, int stream, int range)
+{
+    uint64_t& x = game.rng[stream];
+    x ^= x >> 12;
+    x ^= x << 25;
+    x ^= x >> 27;
+    return static_cast<int>(((x * 0x2545F4914F6CDD1Dull) >> 33) % static_cast<uint64_t>(range));
+}
+void newGame(GameState& game, int lives, int score, int level)
+{
+    game.lives = lives;
+    game.score = score;
+    game.level = level;
+    game.spaceshipCol = game.cols / 2;
+    game.hitEffects.row.clear();
+    game.hitEffects.col.clear();
+    game.hitEffects.timer.clear();
+    restartLevel(game);
+    game.nextSpawnTime = 1.0f + randomInt(game, RNG_SPAWN_TIME, 3);
+    game.nextEnemySpawnTime = 2.0f + randomInt(game, RNG_SPAWN_TIME, 4);
+    game.nextBossSpawnTime = 8.0f + randomInt(game, RNG_SPAWN_TIME, 5);
+    game.nextShieldPowerupSpawnTime = 15.0f + randomInt(game, RNG_SPAWN_TIME, 10);
+}
+void restartLevel(GameState& game)
+{
+    game.killCount = 0;
+    game.bossMoveCounter = 0;
+    game.isInvincible = false;
+    game.hasShield = false;
+    clearGrid(game);
+    for (int i = 0; i < MAX_SHIELD_POWERUPS; i++)
+    {
+        game.shieldPowerupActive[i] = false;
+    }
+    resetSpaceship(game);
+    resetTimers(game.timers);
+    game.events.clear();
+}
+// Simulation passes
+// Put the spaceship in its column on the bottom row. Whatever it moves onto is gone, as it always was, and
+// has to leave its pool too: otherwise that pool's next pass clears the cell and takes the ship with it.
+void placeSpaceship(GameState& game)
+{
+    if (game.grid[game.rows - 1][game.spaceshipCol] >= 2)
+    {
+        removeEntity(game, game.rows - 1, game.spaceshipCol);
+    }
+    game.grid[game.rows - 1][game.spaceshipCol] = 1;
+}
+void movePlayer(GameState& game, const Input& input)
+{
+    // Spaceshipe Movement left right
+    if (cooldownReady(game.timers, TIMER_PLAYER_MOVE, MOVE_COOLDOWN))
+    {
+        bool moved = false;
+        if (input.left && game.spaceshipCol > 0)
+        {
+            game.grid[game.rows - 1][game.spaceshipCol] = 0; // Clear current position
+            game.spaceshipCol--;                        // Move left
+            placeSpaceship(game);
+            moved = true; // trigger cooldown
+        }
+        else if (input.right && game.spaceshipCol < game.cols - 1)
+        {
+            game.grid[game.rows - 1][game.spaceshipCol] = 0; // Clear current position
+            game.spaceshipCol++;                        // Move right
+            placeSpaceship(game);
+            moved = true; // trigger cooldown
+        }
+        if (moved) // restart cooldown timer
+        {
+            game.timers[TIMER_PLAYER_MOVE] -= MOVE_COOLDOWN;
+        }
+    }
+    // Bullet firing
+    if (cooldownReady(game.timers, TIMER_BULLET_FIRE, BULLET_FIRE_COOLDOWN) && input.fire)
+    {
+        int bulletRow = game.rows - 2;  // Just above the spaceship
+        if (bulletRow >= 0 && game.grid[bulletRow][game.spaceshipCol] == 0)
+        {
+            addEntity(game, 3, bulletRow, game.spaceshipCol);
+            addEvent(game, EVENT_SHOT, bulletRow, game.spaceshipCol, 0);
+        }
+        game.timers[TIMER_BULLET_FIRE] -= BULLET_FIRE_COOLDOWN;
+    }
+}
+// One spawn per DEFAULT_COLS columns, so wider boards stay as busy as the normal one
+void spawnWave(GameState& game, int code)
+{
+    int count = game.cols / DEFAULT_COLS;
+    if (count < 1)
+        count = 1;
+    for (int i = 0; i < count; i++)
+    {
+        int randomCol = randomInt(game, RNG_SPAWN_COLUMN, game.cols);  // Any random column
+        if (game.grid[0][randomCol] == 0) // Only spawn if that area is empty
+        {
+            addEntity(game, code, 0, randomCol);
+        }
+    }
+}
+void spawnEntities(GameState& game)
+{
+    // Metoer spawning
+    if (game.timers[TIMER_METEOR_SPAWN] >= game.nextSpawnTime)
+    {
+        spawnWave(game, 2);
+        game.timers[TIMER_METEOR_SPAWN] -= game.nextSpawnTime;
+        game.nextSpawnTime = 1.0f + randomInt(game, RNG_SPAWN_TIME, 3);
+    }
+    // Enemy Spawining
+    if (game.timers[TIMER_ENEMY_SPAWN] >= game.nextEnemySpawnTime)
+    {
+        spawnWave(game, 4);
+        game.timers[TIMER_ENEMY_SPAWN] -= game.nextEnemySpawnTime;
+        float baseTime = 2.0f - (game.level * 0.35f);  // Base spawn time for each level (decreases with level)
+        float variance = 2.5f - (game.level * 0.35f);  // Random variation int he spawning
+        if (baseTime < 0.5f) // should nowt be too fast
+            baseTime = 0.5f;
+        if (variance < 1.0f) // should not be too fast
+            variance = 1.0f;
+        game.nextEnemySpawnTime = baseTime + randomInt(game, RNG_SPAWN_TIME, (int)variance); // calculate time
+    }
+    // Boos spawning
+    if (game.level >= 3 && game.timers[TIMER_BOSS_SPAWN] >= game.nextBossSpawnTime)
+    {
+        spawnWave(game, 5);
+        game.timers[TIMER_BOSS_SPAWN] -= game.nextBossSpawnTime;
+        float bossBaseTime = 10.0f - ((game.level - 3) * 1.5f);  // Decreases with level
+        float bossVariance = 4.0f;  // Random variation
+        // same logic as enemies
+        if (bossBaseTime < 5.0f)
+            bossBaseTime = 5.0f;
+        game.nextBossSpawnTime = bossBaseTime + randomInt(game, RNG_SPAWN_TIME, (int)bossVariance);
+    }
+    // Shield Powerup Spawning
+    if (game.level >= 3 && game.timers[TIMER_SHIELD_SPAWN] >= game.nextShieldPowerupSpawnTime)
+    {
+        for (int i = 0; i < MAX_SHIELD_POWERUPS; i++) // separate array for powerups
+        {
+            if (!game.shieldPowerupActive[i]) // empty slot
+            {
+                int randomCol = randomInt(game, RNG_SPAWN_COLUMN, game.cols);  // Any random column
+                game.shieldPowerupRow[i] = 0;        // Top row
+                game.shieldPowerupCol[i] = randomCol;
+                game.shieldPowerupActive[i] = true;  // powerup now visible
+                break;  // Only 1 powerup
+            }
+        }
+        game.timers[TIMER_SHIELD_SPAWN] -= game.nextShieldPowerupSpawnTime;
+        float shieldBaseTime;
+        float shieldVariance;
+        if (game.level < 5) // 20-35 seconds for levels 3 and 4
+        {
+            shieldBaseTime = 20.0f;
+            shieldVariance = 15.0f;
+        }
+        else // 12-20 seconds for level 5
+        {
+            shieldBaseTime = 12.0f;
+            shieldVariance = 8.0f;
+        }
+        game.nextShieldPowerupSpawnTime = shieldBaseTime + randomInt(game, RNG_SPAWN_TIME, (int)shieldVariance); // calculate time
+    }
+}
+// Movement speeds
+const int poolMoveTimer[POOL_COUNT] = {TIMER_METEOR_MOVE, TIMER_BULLET_MOVE, TIMER_ENEMY_MOVE, TIMER_BOSS_MOVE,
+                                       TIMER_BOSS_BULLET_MOVE};
+float moveInterval(const GameState& game, int pool)
+{
+    if (pool == POOL_METEOR)
+    {
+        float meteorMoveSpeed = 0.7f - ((game.level - 1) * 0.12f); // speed formula based on level (decreases by 0.12s per level)
+        if (meteorMoveSpeed < 0.333f)  // cannot go below 0.333s
+            meteorMoveSpeed = 0.333f;
+        return meteorMoveSpeed;
+    }
+    else if (pool == POOL_ENEMY)
+    {
+        return 0.7f - ((game.level - 1) * 0.12f);  // same speed logic as meteors
+    }
+    else if (pool == POOL_BOSS)
+    {
+        float bossMoveSpeed = 0.8f - ((game.level - 3) * 0.1f);  // same speed logic as enemies
+        if (bossMoveSpeed < 0.5f) // cannot go below 0.5s
+            bossMoveSpeed = 0.5f;
+        return bossMoveSpeed;
+    }
+    else if (pool == POOL_BOSS_BULLET)
+    {
+        return 0.15f; // Move every 0.15 seconds (very fast, regardless of level)
+    }
+    return 0.05f; // player bullets
+}
+float moveProgress(const GameState& game, int pool, float sinceTick)
+{
+    float progress = (game.timers[poolMoveTimer[pool]] + sinceTick) / moveInterval(game, pool);
+    return std::min(std::max(progress, 0.0f), 1.0f);
+}
+// Move every live meteor in the band one row down
+void moveMeteorsInBand(GameState& game, int b)
+{
+    ColumnBand& band = game.bands[b];
+    EntityPool& meteors = band.pools[POOL_METEOR];
+    liftPool(game, meteors);
+    for (size_t i = 0; i < meteors.row.size(); i++)
+    {
+        int r = meteors.row[i];
+        int c = meteors.col[i];
+        meteors.row[i] = -1; // gone unless it finds an empty cell
+        if (r == game.rows - 1) // check if it goes below screen
+        {
+            continue;
+        }
+        if (game.grid[r + 1][c] == 0)
+        {
+            meteors.row[i] = r + 1;  // Place meteor in new position
+        }
+        else if (game.grid[r + 1][c] == 1) // collision with player
+        {
+            addCollision(band.collisions, COLLISION_PLAYER, r + 1, c);
+        }
+        else if (game.grid[r + 1][c] == 3) // collision with bullet
+        {
+            removeEntity(game, r + 1, c);
+            addCollision(band.collisions, COLLISION_METEOR_SHOT, r + 1, c);
+        }
+    }
+    settlePool(game, meteors, 2);
+}
+void moveMeteors(GameState& game)
+{
+    // meteor speed
+    float meteorMoveSpeed = moveInterval(game, POOL_METEOR);
+    if (game.timers[TIMER_METEOR_MOVE] < meteorMoveSpeed)
+    {
+        return;
+    }
+    game.timers[TIMER_METEOR_MOVE] -= meteorMoveSpeed;
+    runBands(game, moveMeteorsInBand);
+    gatherCollisions(game);
+}
+void moveShieldPowerups(GameState& game)
+{
+    if (game.timers[TIMER_SHIELD_MOVE] < 0.5f)
+    {
+        return;
+    }
+    game.timers[TIMER_SHIELD_MOVE] -= 0.5f;
+    for (int i = 0; i < MAX_SHIELD_POWERUPS; i++)
+    {
+        if (game.shieldPowerupActive[i])
+        {
+            if (game.shieldPowerupRow[i] >= game.rows - 1) // moves below screen
+            {
+                game.shieldPowerupActive[i] = false;
+                continue;
+            }
+            if (game.grid[game.shieldPowerupRow[i]][game.shieldPowerupCol[i]] != 1) // not claimed yet
+            {
+                game.shieldPowerupRow[i]++; // move down every time
+            }
+            if (game.grid[game.shieldPowerupRow[i]][game.shieldPowerupCol[i]] == 1) // player claimed shield
+            {
+                addCollision(game.collisions, COLLISION_SHIELD_PICKUP, game.shieldPowerupRow[i],
+                             game.shieldPowerupCol[i]);
+                game.shieldPowerupActive[i] = false;
+            }
+        }
+    }
+}
+void moveEnemiesInBand(GameState& game, int b)
+{
+    ColumnBand& band = game.bands[b];
+    EntityPool& enemies = band.pools[POOL_ENEMY];
+    liftPool(game, enemies);
+    for (size_t i = 0; i < enemies.row.size(); i++)
+    {
+        int r = enemies.row[i];
+        int c = enemies.col[i];
+        enemies.row[i] = -1;
+        if (r == game.rows - 1) // enemy reached bottom
+        {
+            addCollision(band.collisions, COLLISION_PLAYER, r, c);
+        }
+        else if (game.grid[r + 1][c] == 0)
+        {
+            enemies.row[i] = r + 1;
+        }
+        else if (game.grid[r + 1][c] == 1) // collision with player
+        {
+            addCollision(band.collisions, COLLISION_PLAYER_CRASH, r + 1, c);
+        }
+        else if (game.grid[r + 1][c] == 3) // collision with bullet
+        {
+            removeEntity(game, r + 1, c);
+            addCollision(band.collisions, COLLISION_ENEMY_SHOT, r + 1, c);
+        }
+    }
+    settlePool(game, enemies, 4);
+}
+void moveEnemies(GameState& game)
+{
+    float enemyMoveSpeed = moveInterval(game, POOL_ENEMY);
+    if (game.timers[TIMER_ENEMY_MOVE] < enemyMoveSpeed)
+    {
+        return;
+    }
+    game.timers[TIMER_ENEMY_MOVE] -= enemyMoveSpeed;
+    runBands(game, moveEnemiesInBand);
+    gatherCollisions(game);
+}
+void moveBossesInBand(GameState& game, int b)
+{
+    ColumnBand& band = game.bands[b];
+    EntityPool& bosses = band.pools[POOL_BOSS];
+    liftPool(game, bosses);
+    for (size_t i = 0; i < bosses.row.size(); i++)
+    {
+        int r = bosses.row[i];
+        int c = bosses.col[i];
+        bosses.row[i] = -1;
+        if (r == game.rows - 1) // bottom of screen
+        {
+            addCollision(band.collisions, COLLISION_PLAYER, r, c);
+            continue;
+        }
+        int nextRow = r + 1;
+        int nextCell = game.grid[nextRow][c];
+        if (nextCell == 0) // move down
+        {
+            bosses.row[i] = nextRow;
+        }
+        else if (nextCell == 6 || nextCell == 2 || nextCell == 4) // crushes whatever is below
+        {
+            removeEntity(game, nextRow, c);
+            bosses.row[i] = nextRow;
+        }
+        else if (nextCell == 1) // collision with player
+        {
+            addCollision(band.collisions, COLLISION_PLAYER_CRASH, nextRow, c);
+        }
+        else if (nextCell == 3) // collision with bullet
+        {
+            removeEntity(game, nextRow, c);
+            addCollision(band.collisions, COLLISION_BOSS_SHOT, nextRow, c);
+        }
+    }
+    settlePool(game, bosses, 5);
+}
+void moveBosses(GameState& game)
+{
+    float bossMoveSpeed = moveInterval(game, POOL_BOSS);
+    if (game.timers[TIMER_BOSS_MOVE] < bossMoveSpeed)
+    {
+        return;
+    }
+    game.timers[TIMER_BOSS_MOVE] -= bossMoveSpeed;
+    runBands(game, moveBossesInBand);
+    gatherCollisions(game);
+    // Boss bullet firing logic
+    game.bossMoveCounter++; // boss has moved
+    int firingInterval;
+    if (game.level == 3)
+    {
+        firingInterval = 4; // fire bullet every 4 movements
+    }
+    else if (game.level == 4)
+    {
+        firingInterval = 3; // fire every 3 movements
+    }
+    else
+    {
+        firingInterval = 2; // fire every 2 movements
+    }
+    if (game.bossMoveCounter >= firingInterval)
+    {
+        for (size_t b = 0; b < game.bands.size(); b++)
+        {
+            EntityPool& bosses = game.bands[b].pools[POOL_BOSS];
+            for (size_t i = 0; i < bosses.row.size(); i++)
+            {
+                int r = bosses.row[i];
+                int c = bosses.col[i];
+                if (r < game.rows - 1 && game.grid[r + 1][c] == 0) // just below the boss
+                {
+                    addEntity(game, 6, r + 1, c); // create bullet
+                }
+            }
+        }
+        game.bossMoveCounter = 0; // counter reset
+    }
+}
+void moveBossBulletsInBand(GameState& game, int b)
+{
+    ColumnBand& band = game.bands[b];
+    EntityPool& bossBullets = band.pools[POOL_BOSS_BULLET];
+    liftPool(game, bossBullets);
+    for (size_t i = 0; i < bossBullets.row.size(); i++)
+    {
+        int r = bossBullets.row[i];
+        int c = bossBullets.col[i];
+        bossBullets.row[i] = -1;
+        if (r == game.rows - 1)
+        {
+            continue; // remove when below screen
+        }
+        if (game.grid[r + 1][c] == 1) // collision with player
+        {
+            addCollision(band.collisions, COLLISION_PLAYER_BLAST, r + 1, c);
+        }
+        else if (game.grid[r + 1][c] == 2 || game.grid[r + 1][c] == 4)
+        {
+            removeEntity(game, r + 1, c); // bullet moves through anything
+            bossBullets.row[i] = r + 1;
+        }
+        else if (game.grid[r + 1][c] == 0)
+        {
+            bossBullets.row[i] = r + 1;
+        }
+    }
+    settlePool(game, bossBullets, 6);
+}
+void moveBossBullets(GameState& game)
+{
+    float bossBulletSpeed = moveInterval(game, POOL_BOSS_BULLET);
+    if (game.timers[TIMER_BOSS_BULLET_MOVE] < bossBulletSpeed)
+    {
+        return;
+    }
+    game.timers[TIMER_BOSS_BULLET_MOVE] -= bossBulletSpeed;
+    runBands(game, moveBossBulletsInBand);
+    gatherCollisions(game);
+}
+// What a player bullet hitting each grid code counts as
+const int shotCollision[7] = {0, 0, COLLISION_METEOR_SHOT, 0, COLLISION_ENEMY_SHOT, COLLISION_BOSS_SHOT, COLLISION_BOSS_BULLET_SHOT};
+void moveBulletsInBand(GameState& game, int b)
+{
+    ColumnBand& band = game.bands[b];
+    EntityPool& bullets = band.pools[POOL_BULLET];
+    liftPool(game, bullets);
+    for (size_t i = 0; i < bullets.row.size(); i++)
+    {
+        int r = bullets.row[i];
+        int c = bullets.col[i];
+        bullets.row[i] = -1;
+        if (r == 0)
+        {
+            continue; // goes above screen
+        }
+        int target = game.grid[r - 1][c];
+        if (target == 0)
+        {
+            bullets.row[i] = r - 1;  // Move bullet up
+        }
+        else if (target >= 2) // bullet vs meteor, enemy, boss or boss bullet: both are destroyed
+        {
+            removeEntity(game, r - 1, c);
+            addCollision(band.collisions, shotCollision[target], r - 1, c);
+        }
+    }
+    settlePool(game, bullets, 3);
+}
+void moveBullets(GameState& game)
+{
+    // player bullet movement logic almost the same as the boss one
+    float bulletSpeed = moveInterval(game, POOL_BULLET);
+    if (game.timers[TIMER_BULLET_MOVE] < bulletSpeed)
+    {
+        return;
+    }
+    game.timers[TIMER_BULLET_MOVE] -= bulletSpeed;
+    runBands(game, moveBulletsInBand);
+    gatherCollisions(game);
+}
+void updateHitEffects(GameState& game)
+{
+    // hit effect management
+    HitEffectPool& effects = game.hitEffects;
+    size_t i = 0;
+    while (i < effects.timer.size())
+    {
+        effects.timer[i] += TICK_DT;  // time passes
+        if (effects.timer[i] >= HIT_EFFECT_DURATION)  // check if hit effect visible more than 0.3s
+        {
+            removeHitEffect(effects, i); // the last one moves here, look at slot i again
+        }
+        else
+        {
+            i++;
+        }
+    }
+    if (game.isInvincible && game.timers[TIMER_INVINCIBILITY] >= INVINCIBILITY_DURATION)  // check if invincibitly over
+    {
+        game.isInvincible = false;
+    }
+}
+// One simulation tick
+const std::vector<GameEvent>& step(GameState& game, const Input& input)
+{
+    game.events.clear();
+    game.collisions.clear();
+    advanceTimers(game.timers);
+    {
+        PROFILE_SCOPE(PHASE_PLAYER);
+        movePlayer(game, input);
+    }
+    {
+        PROFILE_SCOPE(PHASE_SPAWN);
+        spawnEntities(game);
+    }
+    {
+        PROFILE_SCOPE(PHASE_MOVE_METEORS);
+        moveMeteors(game);
+    }
+    {
+        PROFILE_SCOPE(PHASE_MOVE_SHIELDS);
+        moveShieldPowerups(game);
+    }
+    {
+        PROFILE_SCOPE(PHASE_MOVE_ENEMIES);
+        moveEnemies(game);
+    }
+    {
+        PROFILE_SCOPE(PHASE_MOVE_BOSSES);
+        moveBosses(game);
+    }
+    {
+        PROFILE_SCOPE(PHASE_MOVE_BOSS_BULLETS);
+        moveBossBullets(game);
+    }
+    {
+        PROFILE_SCOPE(PHASE_MOVE_BULLETS);
+        moveBullets(game);
+    }
+    {
+        PROFILE_SCOPE(PHASE_COLLISIONS);
+        resolveCollisions(game);
+    }
+    {
+        PROFILE_SCOPE(PHASE_HIT_EFFECTS);
+        updateHitEffects(game);
+    }
+    return game.events;
+}
@@ -0,0 +1,208 @@
+// Space Shooter gameplay simulation
+// Everything that decides what happens in the game lives here, with no window, input device or audio
+// dependency, so the game logic can run headless (benchmarks, build machines).
+#pragma once
+#include <cstdint>
+#include <vector>
+// Grid Setup: the board size is picked at launch (setupBoard), this is the normal one
+const int DEFAULT_ROWS = 23;
+const int DEFAULT_COLS = 15;
+const int MIN_ROWS = 3; // room for a meteor, a bullet and the player
+// Cells are indexed with int, so rows * cols has to stay well inside one. At the limit the grid and its slot
+// index take 800 MB.
+const int MAX_BOARD_CELLS = 100000000;
+// Column Bands: entities only ever move within their column, so the board is split into bands of columns
+// that the movement passes run on in parallel (see setSimulationThreads)
+const int MIN_BAND_CELLS = 16384; // smaller bands are not worth handing to another thread
+const int MAX_BANDS = 64;
+// Simulation Timing: gameplay advances in fixed ticks, independent of the render frame rate
+const float TICK_RATE = 240.0f;                 // simulation ticks per second
+const float TICK_DT = 1.0f / TICK_RATE;         // seconds of game time per tick
+// Simulation Timers: accumulators advanced by TICK_DT every tick (remainders carry over)
+const int TIMER_METEOR_SPAWN = 0;
+const int TIMER_METEOR_MOVE = 1;
+const int TIMER_ENEMY_SPAWN = 2;
+const int TIMER_ENEMY_MOVE = 3;
+const int TIMER_BOSS_SPAWN = 4;
+const int TIMER_BOSS_MOVE = 5;
+const int TIMER_BOSS_BULLET_MOVE = 6;
+const int TIMER_BULLET_MOVE = 7;
+const int TIMER_SHIELD_SPAWN = 8;
+const int TIMER_SHIELD_MOVE = 9;
+const int TIMER_PLAYER_MOVE = 10;
+const int TIMER_BULLET_FIRE = 11;
+const int TIMER_INVINCIBILITY = 12;
+const int TIMER_COUNT = 13;
+const float MOVE_COOLDOWN = 0.1f;        // Movement Delay to avoid fast movement when key is held
+const float BULLET_FIRE_COOLDOWN = 0.3f; // can shoot bullet only every 0.3 seconds
+// Game Rules
+const int MAX_LEVEL = 5;
+const int MAX_SHIELD_POWERUPS = 5;
+const int DEFAULT_HIT_EFFECTS = 50; // live hit effects on the normal board, bigger boards get more room
+const float HIT_EFFECT_DURATION = 0.3f;
+const float INVINCIBILITY_DURATION = 2.0f;
+// Random Numbers: one generator per subsystem, so a seed always plays out the same game and a change to
+// how often one subsystem rolls does not shift the numbers the others get
+const int RNG_SPAWN_COLUMN = 0;  // where things spawn
+const int RNG_SPAWN_TIME = 1;    // how long until the next spawn
+const int RNG_METEOR_POINTS = 2; // 1 or 2 points per meteor
+const int RNG_COUNT = 3;
+// Gameplay Events reported by step()
+const int EVENT_SHOT = 0;          // player fired a bullet
+const int EVENT_KILL = 1;          // a meteor, enemy or boss was shot down (value = points scored)
+const int EVENT_PLAYER_HIT = 2;    // player was hit (value = 1 if a life was lost, 0 if the shield took it,
+                                   // 2 if the shield took a crash or a boss bullet, which it blows up)
+const int EVENT_SHIELD_PICKUP = 3; // player collected a shield powerup
+const int EVENT_LEVEL_UP = 4;      // level completed, board cleared for the next one
+const int EVENT_GAME_OVER = 5;     // no lives left
+const int EVENT_VICTORY = 6;       // final level completed
+const int EVENT_EXPLOSION = 7;     // something blew up (the hit effect, even if there was no room for it)
+const int EVENT_BULLET_HIT = 8;    // a bullet and a boss bullet took each other out (no points)
+const int EVENT_COUNT = 9;
+// Active Entity Pools: the live meteors, bullets, enemies, bosses and boss bullets (pool = grid code - 2)
+const int POOL_METEOR = 0;
+const int POOL_BULLET = 1;
+const int POOL_ENEMY = 2;
+const int POOL_BOSS = 3;
+const int POOL_BOSS_BULLET = 4;
+const int POOL_COUNT = 5;
+// One int per cell in a single row-major block; grid[r] is a pointer to row r, so cells read as grid[r][c]
+struct BoardGrid
+{
+    int cols;
+    std::vector<int> cells;
+    int* operator[](int row) { return &cells[row * cols]; }
+    const int* operator[](int row) const { return &cells[row * cols]; }
+};
+struct EntityPool
+{
+    std::vector<int> row;
+    std::vector<int> col;
+    std::vector<int> prevRow; // row before the pool's last move, only for drawing (see moveProgress)
+};
+// Live hit effects, packed: a new one goes on the end and an expired one is swapped with the last, so both
+// are O(1) and aging and drawing only visit live effects
+struct HitEffectPool
+{
+    std::vector<int> row;
+    std::vector<int> col;
+    std::vector<float> timer;
+    int capacity;       // live at once (setHitEffectCapacity)
+    long long overflow; // effects dropped because the pool was full, since setupBoard
+};
+// Collisions that change shared state (score, lives, effects, level ups) are recorded by the band they
+// happen in, queued after the pass band by band (so the outcome never depends on which thread finished
+// first) and resolved together at the end of the tick
+const int COLLISION_PLAYER = 0;           // a meteor fell on the player, or an enemy or boss got past it
+const int COLLISION_PLAYER_BLAST = 1;     // boss bullet hit the player (also explodes)
+const int COLLISION_METEOR_SHOT = 2;
+const int COLLISION_ENEMY_SHOT = 3;
+const int COLLISION_BOSS_SHOT = 4;
+const int COLLISION_BOSS_BULLET_SHOT = 5;
+const int COLLISION_SHIELD_PICKUP = 6;    // player ran into a shield powerup
+const int COLLISION_PLAYER_CRASH = 7;     // an enemy or boss flew into the player
+struct Collision
+{
+    int type;
+    int row;
+    int col;
+};
+struct ColumnBand
+{
+    int firstCol; // columns firstCol .. endCol - 1
+    int endCol;
+    EntityPool pools[POOL_COUNT];
+    std::vector<Collision> collisions; // from the pass in progress
+};
+struct GameEvent
+{
+    int type;
+    int row;
+    int col;
+    int value;
+};
+// Player controls for one tick
+struct Input
+{
+    bool left;
+    bool right;
+    bool fire;
+};
+// Complete gameplay state
+struct GameState
+{
+    // Grid System: 0=Empty, 1=Player, 2=Meteor, 3=Bullet, 4=Enemy, 5=Boss, 6=Boss Bullet
+    int rows;
+    int cols;
+    BoardGrid grid;
+    // Every entity on the grid is also in the pool for its type in its column band, and slot[r][c] is its
+    // index there, so movement passes only visit live entities and collisions are a grid lookup
+    int bandCols;
+    std::vector<ColumnBand> bands;
+    BoardGrid slot;
+    int spaceshipCol;
+    int lives;
+    int score;
+    int killCount;
+    int level;
+    int bossMoveCounter;
+    bool isInvincible;
+    bool hasShield;
+    // Shield Powerup System
+    int shieldPowerupRow[MAX_SHIELD_POWERUPS];
+    int shieldPowerupCol[MAX_SHIELD_POWERUPS];
+    bool shieldPowerupActive[MAX_SHIELD_POWERUPS];
+    // Hit Effect System
+    HitEffectPool hitEffects;
+    // All the timers and the randomised spawn intervals they count towards
+    float timers[TIMER_COUNT];
+    float nextSpawnTime;
+    float nextEnemySpawnTime;
+    float nextBossSpawnTime;
+    float nextShieldPowerupSpawnTime;
+    uint64_t rng[RNG_COUNT];
+    // What happened during the last step(): the collisions the passes queued, in pass order, and the events
+    // resolving them gave
+    std::vector<Collision> collisions;
+    std::vector<GameEvent> events;
+};
+// Threads the movement passes may use (1 = everything on the calling thread). Only changes how fast the
+// bands get done, never the result.
+void setSimulationThreads(int threads);
+// At least MIN_ROWS x 1 and at most MAX_BOARD_CELLS cells (check sizes from outside before setupBoard)
+bool validBoardSize(long long rows, long long cols);
+// Game setup (setupBoard comes first, it sizes the grid; seedGame before newGame for a repeatable game)
+void setupBoard(GameState& game, int rows, int cols);
+void setHitEffectCapacity(GameState& game, int capacity); // setupBoard scales it with the board size
+void seedGame(GameState& game, uint64_t seed);
+int randomInt(GameState& game, int stream, int range); // 0 .. range - 1
+void newGame(GameState& game, int lives, int score, int level);
+void restartLevel(GameState& game);
+// Advance the game by one tick (TICK_DT seconds) and report what happened
+const std::vector<GameEvent>& step(GameState& game, const Input& input);
+// Individual simulation passes, in the order step() runs them
+void movePlayer(GameState& game, const Input& input);
+void spawnEntities(GameState& game);
+void moveMeteors(GameState& game);
+void moveShieldPowerups(GameState& game);
+void moveEnemies(GameState& game);
+void moveBosses(GameState& game);
+void moveBossBullets(GameState& game);
+void moveBullets(GameState& game);
+void resolveCollisions(GameState& game); // nothing counts after a level up, game over or victory
+void updateHitEffects(GameState& game);
+// Seconds between two moves of a pool's entities at the game's level
+float moveInterval(const GameState& game, int pool);
+// How far (0 .. 1) a pool's entities are from prevRow to row, sinceTick seconds after the last tick: the
+// glide takes one move interval. Only for drawing, the simulation itself moves whole cells.
+float moveProgress(const GameState& game, int pool, float sinceTick);
+// Grid helpers (entities must be added and removed through these to keep the pools in step)
+EntityPool& poolAt(GameState& game, int code, int col);
+void addEntity(GameState& game, int code, int row, int col);
+void removeEntity(GameState& game, int row, int col);
+void rebuildPools(GameState& game);
+void createExplosionEffect(GameState& game, int row, int col);
+void clearGrid(GameState& game);
+void clearEntities(GameState& game);
+void resetSpaceship(GameState& game);
+void resetTimers(float timers[]);
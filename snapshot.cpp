@@ -0,0 +1,319 @@
+#include "snapshot.h"
+#include "bytes.h"
+#include <algorithm>
+#include <cstring>
+#include <utility>
+using namespace std;
+void putUint(vector<uint8_t>& bytes, uint64_t value, int size)
+{
+    putLittleEndian(bytes, value, size);
+}
+void putVarint(vector<uint8_t>& bytes, uint64_t value)
+{
+    while (value >= 0x80)
+    {
+        bytes.push_back(static_cast<uint8_t>((value & 0x7F) | 0x80));
+        value >>= 7;
+    }
+    bytes.push_back(static_cast<uint8_t>(value));
+}
+bool getUint(ByteReader& reader, uint64_t& value, int size)
+{
+    if (reader.size - reader.pos < static_cast<size_t>(size))
+    {
+        return false;
+    }
+    value = getLittleEndian(reader.data + reader.pos, size);
+    reader.pos += size;
+    return true;
+}
+bool getVarint(ByteReader& reader, uint64_t& value)
+{
+    value = 0;
+    for (int shift = 0; shift < 64 && reader.pos < reader.size; shift += 7)
+    {
+        uint8_t byte = reader.data[reader.pos++];
+        value |= static_cast<uint64_t>(byte & 0x7F) << shift;
+        if ((byte & 0x80) == 0)
+        {
+            return true;
+        }
+    }
+    return false;
+}
+// ints and floats go in as their 32 bit patterns
+void putInt(vector<uint8_t>& bytes, int value)
+{
+    putUint(bytes, static_cast<uint32_t>(value), 4);
+}
+void putFloat(vector<uint8_t>& bytes, float value)
+{
+    uint32_t bits;
+    memcpy(&bits, &value, 4);
+    putUint(bytes, bits, 4);
+}
+bool getInt(ByteReader& reader, int& value)
+{
+    uint64_t bits;
+    if (!getUint(reader, bits, 4))
+    {
+        return false;
+    }
+    value = static_cast<int32_t>(static_cast<uint32_t>(bits));
+    return true;
+}
+bool getFloat(ByteReader& reader, float& value)
+{
+    uint64_t bits;
+    if (!getUint(reader, bits, 4))
+    {
+        return false;
+    }
+    uint32_t bits32 = static_cast<uint32_t>(bits);
+    memcpy(&value, &bits32, 4);
+    return true;
+}
+bool getFlag(ByteReader& reader, bool& value)
+{
+    uint64_t byte;
+    if (!getUint(reader, byte, 1) || byte > 1)
+    {
+        return false;
+    }
+    value = byte == 1;
+    return true;
+}
+void saveState(const GameState& game, vector<uint8_t>& bytes)
+{
+    bytes.clear();
+    putInt(bytes, game.rows);
+    putInt(bytes, game.cols);
+    // Grid: runs of the same cell code (mostly long runs of empty cells)
+    const vector<int>& cells = game.grid.cells;
+    size_t i = 0;
+    while (i < cells.size())
+    {
+        size_t run = 1;
+        while (i + run < cells.size() && cells[i + run] == cells[i])
+        {
+            run++;
+        }
+        bytes.push_back(static_cast<uint8_t>(cells[i]));
+        putVarint(bytes, run);
+        i += run;
+    }
+    // Entities of each type, band by band in pool order
+    for (int p = 0; p < POOL_COUNT; p++)
+    {
+        size_t count = 0;
+        for (size_t b = 0; b < game.bands.size(); b++)
+        {
+            count += game.bands[b].pools[p].row.size();
+        }
+        putVarint(bytes, count);
+        for (size_t b = 0; b < game.bands.size(); b++)
+        {
+            const EntityPool& pool = game.bands[b].pools[p];
+            for (size_t e = 0; e < pool.row.size(); e++)
+            {
+                putVarint(bytes, pool.row[e]);
+                putVarint(bytes, pool.col[e]);
+            }
+        }
+    }
+    int values[8] = {game.spaceshipCol, game.lives, game.score, game.killCount, game.level, game.bossMoveCounter,
+                     game.isInvincible, game.hasShield};
+    for (int v = 0; v < 8; v++)
+    {
+        putInt(bytes, values[v]);
+    }
+    // Powerups and effects: only the active slots mean anything
+    for (int s = 0; s < MAX_SHIELD_POWERUPS; s++)
+    {
+        bytes.push_back(game.shieldPowerupActive[s] ? 1 : 0);
+        if (game.shieldPowerupActive[s])
+        {
+            putInt(bytes, game.shieldPowerupRow[s]);
+            putInt(bytes, game.shieldPowerupCol[s]);
+        }
+    }
+    const HitEffectPool& effects = game.hitEffects;
+    putVarint(bytes, effects.row.size());
+    for (size_t h = 0; h < effects.row.size(); h++)
+    {
+        putInt(bytes, effects.row[h]);
+        putInt(bytes, effects.col[h]);
+        putFloat(bytes, effects.timer[h]);
+    }
+    for (int t = 0; t < TIMER_COUNT; t++)
+    {
+        putFloat(bytes, game.timers[t]);
+    }
+    putFloat(bytes, game.nextSpawnTime);
+    putFloat(bytes, game.nextEnemySpawnTime);
+    putFloat(bytes, game.nextBossSpawnTime);
+    putFloat(bytes, game.nextShieldPowerupSpawnTime);
+    for (int r = 0; r < RNG_COUNT; r++)
+    {
+        putUint(bytes, game.rng[r], 8);
+    }
+}
+// Decodes into game, which may be left half filled in if the bytes are bad (loadState hands it a copy)
+bool decodeState(GameState& game, const uint8_t bytes[], size_t size)
+{
+    ByteReader reader = {bytes, size, 0};
+    int rows, cols;
+    if (!getInt(reader, rows) || !getInt(reader, cols) || rows != game.rows || cols != game.cols)
+    {
+        return false;
+    }
+    clearGrid(game);
+    vector<int>& cells = game.grid.cells;
+    size_t filled = 0;
+    size_t entityCells = 0;
+    size_t playerCells = 0;
+    while (filled < cells.size())
+    {
+        uint64_t code, run;
+        if (!getUint(reader, code, 1) || code > 6 || !getVarint(reader, run) || run == 0 ||
+            run > cells.size() - filled)
+        {
+            return false;
+        }
+        fill(cells.begin() + filled, cells.begin() + filled + run, static_cast<int>(code));
+        if (code >= 2)
+        {
+            entityCells += run;
+        }
+        else if (code == 1)
+        {
+            playerCells += run;
+        }
+        filled += run;
+    }
+    // Every entity on the grid has to come back in its pool, in the same order
+    for (int p = 0; p < POOL_COUNT; p++)
+    {
+        uint64_t count;
+        if (!getVarint(reader, count) || count > entityCells)
+        {
+            return false;
+        }
+        for (uint64_t e = 0; e < count; e++)
+        {
+            uint64_t row, col;
+            if (!getVarint(reader, row) || !getVarint(reader, col) || row >= static_cast<uint64_t>(rows) ||
+                col >= static_cast<uint64_t>(cols) || game.grid[row][col] != p + 2)
+            {
+                return false;
+            }
+            addEntity(game, p + 2, static_cast<int>(row), static_cast<int>(col));
+        }
+        entityCells -= count;
+    }
+    if (entityCells != 0)
+    {
+        return false;
+    }
+    int values[8];
+    for (int v = 0; v < 8; v++)
+    {
+        if (!getInt(reader, values[v]))
+        {
+            return false;
+        }
+    }
+    game.spaceshipCol = values[0];
+    game.lives = values[1];
+    game.score = values[2];
+    game.killCount = values[3];
+    game.level = values[4];
+    game.bossMoveCounter = values[5];
+    game.isInvincible = values[6] != 0;
+    game.hasShield = values[7] != 0;
+    // Exactly one ship, on the bottom row at spaceshipCol
+    if (game.spaceshipCol < 0 || game.spaceshipCol >= cols || playerCells != 1 ||
+        game.grid[rows - 1][game.spaceshipCol] != 1)
+    {
+        return false;
+    }
+    for (int s = 0; s < MAX_SHIELD_POWERUPS; s++)
+    {
+        game.shieldPowerupRow[s] = 0;
+        game.shieldPowerupCol[s] = 0;
+        if (!getFlag(reader, game.shieldPowerupActive[s]))
+        {
+            return false;
+        }
+        if (game.shieldPowerupActive[s] &&
+            (!getInt(reader, game.shieldPowerupRow[s]) || !getInt(reader, game.shieldPowerupCol[s]) ||
+             game.shieldPowerupRow[s] < 0 || game.shieldPowerupRow[s] >= rows ||
+             game.shieldPowerupCol[s] < 0 || game.shieldPowerupCol[s] >= cols))
+        {
+            return false;
+        }
+    }
+    // Effects past this game's capacity (saved with a bigger one) are dropped like any other overflow
+    HitEffectPool& effects = game.hitEffects;
+    effects.row.clear();
+    effects.col.clear();
+    effects.timer.clear();
+    uint64_t effectCount;
+    if (!getVarint(reader, effectCount) || effectCount > (reader.size - reader.pos) / 12)
+    {
+        return false;
+    }
+    for (uint64_t h = 0; h < effectCount; h++)
+    {
+        int row, col;
+        float timer;
+        if (!getInt(reader, row) || !getInt(reader, col) || !getFloat(reader, timer) || row < 0 || row >= rows ||
+            col < 0 || col >= cols)
+        {
+            return false;
+        }
+        if (static_cast<int>(effects.row.size()) < effects.capacity)
+        {
+            effects.row.push_back(row);
+            effects.col.push_back(col);
+            effects.timer.push_back(timer);
+        }
+        else
+        {
+            effects.overflow++;
+        }
+    }
+    for (int t = 0; t < TIMER_COUNT; t++)
+    {
+        if (!getFloat(reader, game.timers[t]))
+        {
+            return false;
+        }
+    }
+    if (!getFloat(reader, game.nextSpawnTime) || !getFloat(reader, game.nextEnemySpawnTime) ||
+        !getFloat(reader, game.nextBossSpawnTime) || !getFloat(reader, game.nextShieldPowerupSpawnTime))
+    {
+        return false;
+    }
+    for (int r = 0; r < RNG_COUNT; r++)
+    {
+        if (!getUint(reader, game.rng[r], 8))
+        {
+            return false;
+        }
+    }
+    game.events.clear();
+    game.collisions.clear();
+    return reader.pos == reader.size;
+}
+bool loadState(GameState& game, const uint8_t bytes[], size_t size)
+{
+    // A bad snapshot leaves the game as it was
+    GameState loaded = game;
+    if (!decodeState(loaded, bytes, size))
+    {
+        return false;
+    }
+    game = move(loaded);
+    return true;
+}
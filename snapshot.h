@@ -0,0 +1,24 @@
+// Game state snapshots
+// The whole gameplay state as a flat block of bytes, to put a game back exactly where it was (replay
+// keyframes). Entities are stored in pool order, because the order the passes visit them in decides
+// which of two colliding things gets there first.
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include "simulation.h"
+void saveState(const GameState& game, std::vector<uint8_t>& bytes);
+// The game must already be set up for the same board size; returns false, and leaves the game alone, if
+// the bytes do not fit it
+bool loadState(GameState& game, const uint8_t bytes[], size_t size);
+// Little-endian integers (bytes.h) with bounds checked reads, and LEB128 varints
+void putUint(std::vector<uint8_t>& bytes, uint64_t value, int size);
+void putVarint(std::vector<uint8_t>& bytes, uint64_t value);
+struct ByteReader
+{
+    const uint8_t* data;
+    size_t size;
+    size_t pos;
+};
+bool getUint(ByteReader& reader, uint64_t& value, int size);
+bool getVarint(ByteReader& reader, uint64_t& value);
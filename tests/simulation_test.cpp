@@ -0,0 +1,394 @@
+// Simulation regression tests: headless checks of the game rules, run by ctest
+#include "simulation.h"
+#include "input.h"
+#include "replay.h"
+#include "savegame.h"
+#include "snapshot.h"
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+using namespace std;
+int failures = 0;
+void check(bool ok, const char what[])
+{
+    if (!ok)
+    {
+        cerr << "FAILED: " << what << endl;
+        failures++;
+    }
+}
+GameState freshGame()
+{
+    GameState game;
+    setupBoard(game, DEFAULT_ROWS, DEFAULT_COLS);
+    seedGame(game, 1);
+    newGame(game, 3, 0, 1);
+    return game;
+}
+size_t poolSize(GameState& game, int code, int col)
+{
+    return poolAt(game, code, col).row.size();
+}
+// Run one pass of every pool right now, whatever their timers say
+void movePoolsNow(GameState& game)
+{
+    game.timers[TIMER_METEOR_MOVE] = 10.0f;
+    game.timers[TIMER_ENEMY_MOVE] = 10.0f;
+    game.timers[TIMER_BOSS_MOVE] = 10.0f;
+    game.timers[TIMER_BOSS_BULLET_MOVE] = 10.0f;
+    moveMeteors(game);
+    moveEnemies(game);
+    moveBosses(game);
+    moveBossBullets(game);
+}
+// The ship moving onto a meteor, enemy, boss or boss bullet on the bottom row has to take it off its pool
+// too, or that pool's next pass clears the ship's cell and things fall through the ship
+void testMoveOntoBottomRowEntity(int code)
+{
+    GameState game = freshGame();
+    int target = game.spaceshipCol - 1;
+    addEntity(game, code, game.rows - 1, target);
+    Input left = {true, false, false};
+    movePlayer(game, left);
+    check(game.spaceshipCol == target, "ship moved left");
+    check(game.grid[game.rows - 1][target] == 1, "ship is on the grid where it moved");
+    check(poolSize(game, code, target) == 0, "entity under the ship left its pool");
+    movePoolsNow(game);
+    check(game.grid[game.rows - 1][target] == 1, "ship still on the grid after the pools moved");
+    // a meteor dropping onto the ship still hits it
+    game.collisions.clear();
+    game.events.clear();
+    addEntity(game, 2, game.rows - 2, target);
+    game.timers[TIMER_METEOR_MOVE] = 10.0f;
+    moveMeteors(game);
+    resolveCollisions(game);
+    check(game.lives == 2, "meteor dropped onto the ship costs a life");
+    check(game.grid[game.rows - 1][target] == 1, "ship still on the grid after the hit");
+}
+// The shield blows up an enemy that crashes into it, a meteor just takes the shield down (the game plays
+// the explosion and the damage sound for them)
+int shieldHitValue(int code)
+{
+    GameState game = freshGame();
+    game.hasShield = true;
+    addEntity(game, code, game.rows - 2, game.spaceshipCol);
+    movePoolsNow(game);
+    resolveCollisions(game);
+    for (size_t i = 0; i < game.events.size(); i++)
+    {
+        if (game.events[i].type == EVENT_PLAYER_HIT)
+        {
+            return game.events[i].value;
+        }
+    }
+    return -1;
+}
+void testShieldHits()
+{
+    check(shieldHitValue(2) == 0, "shield takes a meteor quietly");
+    check(shieldHitValue(4) == 2, "shield blows up an enemy");
+    check(shieldHitValue(5) == 2, "shield blows up a boss");
+    check(shieldHitValue(6) == 2, "shield blows up a boss bullet");
+}
+// One tick of the game taking its input from the buffer, returns where the ship ended up
+int inputTick(InputBuffer& buffer, GameState& game)
+{
+    Input input = takeTickInput(buffer, game);
+    movePlayer(game, input);
+    return game.spaceshipCol;
+}
+// Taps shorter than a tick act on the next tick, held keys repeat at the cooldown, and a tap that loses to
+// a held key is dropped instead of acting once the held key is let go
+void testTapsAndHeldKeys()
+{
+    GameState game = freshGame();
+    InputBuffer buffer;
+    resetInput(buffer);
+    int start = game.spaceshipCol;
+    // tap: down and up before the tick
+    pushInput(buffer, INPUT_LEFT, true, 0.0);
+    pushInput(buffer, INPUT_LEFT, false, 0.001);
+    check(inputTick(buffer, game) == start - 1, "tap moves on the next tick");
+    for (int t = 0; t < 60; t++)
+    {
+        inputTick(buffer, game);
+    }
+    check(game.spaceshipCol == start - 1, "tap moves only once");
+    // tap during the move cooldown: waits for it, then moves once
+    pushInput(buffer, INPUT_RIGHT, true, 1.0);
+    pushInput(buffer, INPUT_RIGHT, false, 1.001);
+    inputTick(buffer, game);
+    pushInput(buffer, INPUT_RIGHT, true, 1.01);
+    pushInput(buffer, INPUT_RIGHT, false, 1.011);
+    check(inputTick(buffer, game) == start, "second tap waits for the cooldown");
+    for (int t = 0; t < 60; t++)
+    {
+        inputTick(buffer, game);
+    }
+    check(game.spaceshipCol == start + 1, "tap made during the cooldown moves once it ends");
+    // held: one move per cooldown (0.1 s = 24 ticks)
+    pushInput(buffer, INPUT_LEFT, true, 2.0);
+    for (int t = 0; t < 48; t++)
+    {
+        inputTick(buffer, game);
+    }
+    check(game.spaceshipCol == start - 1, "held key repeats at the move cooldown");
+    // right tap while left is held: left wins, and the tap must not move the ship after left is let go
+    pushInput(buffer, INPUT_RIGHT, true, 2.5);
+    pushInput(buffer, INPUT_RIGHT, false, 2.501);
+    for (int t = 0; t < 24; t++)
+    {
+        inputTick(buffer, game);
+    }
+    int beforeRelease = game.spaceshipCol;
+    pushInput(buffer, INPUT_LEFT, false, 3.0);
+    for (int t = 0; t < 60; t++)
+    {
+        inputTick(buffer, game);
+    }
+    check(game.spaceshipCol == beforeRelease, "right tap lost to held left never moves the ship");
+}
+// Board sizes from the command line and from replay files are checked before setupBoard sees them
+void testBoardSizeLimits()
+{
+    check(validBoardSize(DEFAULT_ROWS, DEFAULT_COLS), "normal board is valid");
+    check(validBoardSize(10000, 10000), "board at the cell limit is valid");
+    check(!validBoardSize(MIN_ROWS - 1, 10), "too few rows are refused");
+    check(!validBoardSize(10, 0), "no columns are refused");
+    check(!validBoardSize(10000, 10001), "board past the cell limit is refused");
+    check(!validBoardSize(4294967295LL, 4294967295LL), "board whose cell count overflows is refused");
+}
+// Scripted player for recordings: sweeping left and right, firing, with a pause menu restart now and then
+Input scriptedInput(long long tick)
+{
+    Input input = {(tick / 500) % 2 == 0, (tick / 500) % 2 == 1, tick % 3 != 0};
+    return input;
+}
+// Record `ticks` ticks of a seeded game on a board big enough for several column bands; returns the final
+// state's checksum
+uint64_t recordGame(Replay& replay, long long ticks)
+{
+    GameState game;
+    setupBoard(game, 200, 300);
+    startRecording(replay, game, 12345, 3, 0, 3, 1000);
+    for (long long tick = 0; tick < ticks; tick++)
+    {
+        bool restart = tick % 2500 == 2499;
+        if (restart)
+        {
+            restartLevel(game);
+        }
+        Input input = scriptedInput(tick);
+        recordTick(replay, game, input, restart);
+        const vector<GameEvent>& events = step(game, input);
+        for (size_t i = 0; i < events.size(); i++)
+        {
+            if (events[i].type == EVENT_GAME_OVER || events[i].type == EVENT_VICTORY)
+            {
+                return stateChecksum(game); // nothing to record past the end of the game
+            }
+        }
+    }
+    return stateChecksum(game);
+}
+// Playing a recording back, from memory or from its file and with any thread count, ends where the game did
+void testRecordAndReplay()
+{
+    Replay replay;
+    uint64_t recorded = recordGame(replay, 6000);
+    check(saveReplay(replay, "test-record.ssr"), "replay saves");
+    Replay loaded;
+    check(loadReplay(loaded, "test-record.ssr"), "replay loads");
+    remove("test-record.ssr");
+    check(loaded.ticks == replay.ticks && loaded.keyframes.size() == replay.keyframes.size(), "replay file round trips");
+    for (int threads = 1; threads <= 4; threads += 3)
+    {
+        setSimulationThreads(threads);
+        GameState game;
+        setupBoard(game, loaded.rows, loaded.cols);
+        check(startPlayback(loaded, game), "playback starts");
+        for (long long tick = 0; tick < static_cast<long long>(loaded.ticks.size()); tick++)
+        {
+            playTick(loaded, game, tick);
+        }
+        check(stateChecksum(game) == recorded, "replay ends with the recorded checksum");
+    }
+    setSimulationThreads(1);
+}
+// Seeking through keyframes lands in the same state as playing every tick from the start
+void testSeekMatchesStraightReplay()
+{
+    Replay replay;
+    recordGame(replay, 6000);
+    check(replay.keyframes.size() > 1, "recording has keyframes");
+    GameState straight;
+    setupBoard(straight, replay.rows, replay.cols);
+    startPlayback(replay, straight);
+    GameState seeked;
+    setupBoard(seeked, replay.rows, replay.cols);
+    const long long targets[4] = {0, 999, 1000, 5321}; // start, either side of a keyframe, between two
+    int next = 0;
+    for (long long tick = 0; tick <= 5321; tick++)
+    {
+        if (tick == targets[next])
+        {
+            check(seekReplay(replay, seeked, tick), "seek succeeds");
+            check(stateChecksum(seeked) == stateChecksum(straight), "seek matches playing straight through");
+            next++;
+        }
+        playTick(replay, straight, tick);
+    }
+    check(!seekReplay(replay, seeked, static_cast<long long>(replay.ticks.size()) + 1), "seek past the end fails");
+}
+// The checksum sees the order entities sit in their pools, not just the grid
+void testChecksumSeesPoolOrder()
+{
+    GameState first = freshGame();
+    GameState second = freshGame();
+    addEntity(first, 2, 3, 1);
+    addEntity(first, 2, 5, 2);
+    addEntity(second, 2, 5, 2);
+    addEntity(second, 2, 3, 1);
+    check(first.grid.cells == second.grid.cells, "same grid either way");
+    check(stateChecksum(first) != stateChecksum(second), "different pool order, different checksum");
+}
+// Replay header with the given board size and tick count, and one run of input covering every tick
+bool loadsAsReplay(uint64_t rows, uint64_t cols, uint64_t tickCount)
+{
+    vector<uint8_t> bytes = {'S', 'S', 'R', 'P'};
+    putUint(bytes, REPLAY_VERSION, 4);
+    putUint(bytes, 1, 8); // seed
+    putUint(bytes, rows, 4);
+    putUint(bytes, cols, 4);
+    putUint(bytes, 3, 4); // lives, score, level
+    putUint(bytes, 0, 4);
+    putUint(bytes, 1, 4);
+    putUint(bytes, tickCount, 8);
+    bytes.push_back(0);
+    putVarint(bytes, tickCount);
+    putUint(bytes, 0, 4); // no keyframes, no start state
+    putVarint(bytes, 0);
+    putVarint(bytes, 0);
+    const char path[] = "test-limits.ssr";
+    ofstream(path, ios::binary).write(reinterpret_cast<const char*>(bytes.data()), bytes.size());
+    Replay replay;
+    bool loaded = loadReplay(replay, path);
+    remove(path);
+    return loaded;
+}
+// A few bytes of replay file must not be able to ask for a huge board or billions of ticks
+void testReplayFileLimits()
+{
+    check(loadsAsReplay(DEFAULT_ROWS, DEFAULT_COLS, 1000), "small replay loads");
+    check(!loadsAsReplay(0xFFFFFFFFu, DEFAULT_COLS, 1000), "replay with rows past int is refused");
+    check(!loadsAsReplay(100000, 100000, 1000), "replay past the cell limit is refused");
+    check(!loadsAsReplay(DEFAULT_ROWS, DEFAULT_COLS, MAX_REPLAY_TICKS + 1), "replay past the tick limit is refused");
+}
+// Snapshots hold exactly one ship, where spaceshipCol says
+void testSnapshotNeedsTheShip()
+{
+    GameState game = freshGame();
+    addEntity(game, 2, game.rows - 1, 0);
+    vector<uint8_t> bytes;
+    saveState(game, bytes);
+    GameState loaded = freshGame();
+    check(loadState(loaded, bytes.data(), bytes.size()), "snapshot loads");
+    check(loaded.grid.cells == game.grid.cells, "snapshot gives the same grid");
+    game.grid[game.rows - 1][game.spaceshipCol] = 0;
+    saveState(game, bytes);
+    check(!loadState(loaded, bytes.data(), bytes.size()), "snapshot without the ship is rejected");
+}
+// A game in the middle of play survives saveState/loadState exactly, and keeps playing the same after it
+void testSnapshotRoundTrip()
+{
+    Replay replay;
+    recordGame(replay, 3000);
+    GameState game;
+    setupBoard(game, replay.rows, replay.cols);
+    seekReplay(replay, game, 2500);
+    vector<uint8_t> bytes;
+    saveState(game, bytes);
+    GameState loaded;
+    setupBoard(loaded, replay.rows, replay.cols);
+    check(loadState(loaded, bytes.data(), bytes.size()), "mid-game snapshot loads");
+    check(stateChecksum(loaded) == stateChecksum(game), "snapshot round trips");
+    for (long long tick = 2500; tick < 3000; tick++)
+    {
+        playTick(replay, game, tick);
+        playTick(replay, loaded, tick);
+    }
+    check(stateChecksum(loaded) == stateChecksum(game), "loaded game plays on the same");
+    bytes.pop_back();
+    check(!loadState(loaded, bytes.data(), bytes.size()), "cut short snapshot is refused");
+}
+// A save file whose payload no longer matches its checksum does not load (writes save-slot-3.sav)
+void testDamagedSaveRefused()
+{
+    const int slot = SAVE_SLOTS - 1;
+    GameState game = freshGame();
+    game.score = 42;
+    check(saveGame(game, slot), "game saves");
+    GameState loaded = freshGame();
+    check(loadGame(loaded, slot) && loaded.score == 42, "saved game loads");
+    const char path[] = "save-slot-3.sav";
+    vector<uint8_t> bytes;
+    {
+        ifstream file(path, ios::binary);
+        bytes.assign(istreambuf_iterator<char>(file), istreambuf_iterator<char>());
+    }
+    bytes[bytes.size() - 10] ^= 0x40; // one bit of the payload
+    ofstream(path, ios::binary).write(reinterpret_cast<const char*>(bytes.data()), bytes.size());
+    check(!loadGame(loaded, slot), "damaged save is refused");
+    deleteSave(slot);
+}
+// Queued writes to the same file collapse into the newest one, and flushSaves waits until it is on disk.
+// Slot occupancy follows the queue without reading the files. (Writes save-slot-3.sav in the working folder.)
+void testQueuedSaves()
+{
+    const int slot = SAVE_SLOTS - 1;
+    GameState game = freshGame();
+    for (int score = 10; score <= 30; score += 10)
+    {
+        game.score = score;
+        queueSave(game, slot);
+    }
+    check(slotInUse(slot), "queued save marks the slot used");
+    SaveSummary summary;
+    check(readSaveSummary(slot, summary) && summary.score == 30, "queued save reads back before it is written");
+    flushSaves();
+    check(readSaveSummary(slot, summary) && summary.score == 30, "newest queued save is the one on disk");
+    GameState loaded = freshGame();
+    check(loadGame(loaded, slot) && loaded.score == 30, "flushed save loads");
+    queueDeleteSave(slot);
+    check(!slotInUse(slot), "queued delete frees the slot");
+    flushSaves();
+    check(!readSaveSummary(slot, summary), "deleted save is gone from disk");
+    scanSaveSlots();
+    check(!slotInUse(slot), "scanning the files agrees");
+}
+int main()
+{
+    testMoveOntoBottomRowEntity(2);
+    testMoveOntoBottomRowEntity(4);
+    testMoveOntoBottomRowEntity(5);
+    testMoveOntoBottomRowEntity(6);
+    testShieldHits();
+    testTapsAndHeldKeys();
+    testBoardSizeLimits();
+    testReplayFileLimits();
+    testRecordAndReplay();
+    testChecksumSeesPoolOrder();
+    testSeekMatchesStraightReplay();
+    testSnapshotNeedsTheShip();
+    testSnapshotRoundTrip();
+    testDamagedSaveRefused();
+    testQueuedSaves();
+    if (failures > 0)
+    {
+        cerr << failures << " check(s) failed" << endl;
+        return 1;
+    }
+    cout << "all simulation tests passed" << endl;
+    return 0;
+}
@@ -0,0 +1,112 @@
+// Headless input latency harness: plays scripted key presses through the input buffer and the simulation
+// on a simulated frame clock and prints the same press to display report as --latency-report. Nothing
+// depends on how fast the machine is, so a seed gives the same numbers every run.
+// A frame polls the presses that came in since the last one, runs the ticks it owes, draws at once and is
+// displayed at the next vsync, one frame period later. Ticks and drawing take no time on this clock, so the
+// report leaves out tick -> draw (the game's --latency-report has it).
+// Usage: latency_harness [--seconds N] [--fps N] [--seed N]
+#include "simulation.h"
+#include "input.h"
+#include "latency.h"
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <random>
+#include <vector>
+using namespace std;
+int main(int argc, char* argv[])
+{
+    double seconds = 300.0; // of game time
+    double fps = 60.0;
+    unsigned seed = 1;
+    for (int i = 1; i < argc; i++)
+    {
+        if (strcmp(argv[i], "--seconds") == 0 && i + 1 < argc)
+        {
+            seconds = atof(argv[++i]);
+        }
+        else if (strcmp(argv[i], "--fps") == 0 && i + 1 < argc)
+        {
+            fps = atof(argv[++i]);
+        }
+        else if (strcmp(argv[i], "--seed") == 0 && i + 1 < argc)
+        {
+            seed = static_cast<unsigned>(atoi(argv[++i]));
+        }
+        else
+        {
+            cerr << "Usage: latency_harness [--seconds N] [--fps N] [--seed N]" << endl;
+            return 1;
+        }
+    }
+    if (fps <= 0.0 || seconds <= 0.0)
+    {
+        cerr << "--fps and --seconds must be above 0" << endl;
+        return 1;
+    }
+    GameState game;
+    setupBoard(game, DEFAULT_ROWS, DEFAULT_COLS);
+    seedGame(game, seed);
+    newGame(game, 3, 0, 1);
+    InputBuffer buffer;
+    resetInput(buffer);
+    LatencyTracker tracker;
+    // Scripted player: a press every 50-400 ms, held 20-120 ms, half of them fire and half move the ship back
+    // towards the middle so moves are not lost against the edge
+    mt19937 script(seed);
+    uniform_real_distribution<double> gap(0.05, 0.4);
+    uniform_real_distribution<double> hold(0.02, 0.12);
+    double nextPress = gap(script);
+    int heldKey = -1;
+    double releaseTime = 0.0;
+    double framePeriod = 1.0 / fps;
+    float tickAccumulator = 0.0f;
+    long long frames = 0;
+    for (double now = 0.0; now < seconds; now = ++frames * framePeriod)
+    {
+        // Everything that happened since the last poll, stamped with when it happened
+        while (true)
+        {
+            if (heldKey >= 0 && releaseTime <= now)
+            {
+                pushInput(buffer, heldKey, false, releaseTime);
+                heldKey = -1;
+            }
+            else if (heldKey < 0 && nextPress <= now)
+            {
+                bool fire = script() % 2 == 0;
+                heldKey = fire ? INPUT_FIRE : game.spaceshipCol < game.cols / 2 ? INPUT_RIGHT : INPUT_LEFT;
+                pushInput(buffer, heldKey, true, nextPress);
+                releaseTime = nextPress + hold(script);
+                nextPress = releaseTime + gap(script);
+            }
+            else
+            {
+                break;
+            }
+        }
+        tickAccumulator += static_cast<float>(framePeriod);
+        while (tickAccumulator >= TICK_DT)
+        {
+            tickAccumulator -= TICK_DT;
+            Input input = takeTickInput(buffer, game);
+            int shipColBefore = game.spaceshipCol;
+            const vector<GameEvent>& events = step(game, input);
+            latencyTick(tracker, buffer, shipColBefore, game, events, now);
+            bool gameEnded = false;
+            for (size_t i = 0; i < events.size(); i++)
+            {
+                gameEnded = gameEnded || events[i].type == EVENT_GAME_OVER || events[i].type == EVENT_VICTORY;
+            }
+            if (gameEnded) // straight into the next game
+            {
+                newGame(game, 3, 0, 1);
+            }
+        }
+        latencyDrawn(tracker, now);
+        latencyDisplayed(tracker, now + framePeriod);
+    }
+    cout << "scripted input, " << seconds << " s at " << fps << " fps, seed " << seed << endl;
+    printLatencyReport(tracker, false);
+    return 0;
+}
@@ -0,0 +1,25 @@
+// Builds the asset pack the game loads its images, sounds and font from
+// Usage: pack_builder <assets directory> <pack file>
+#include "pack.h"
+#include <iostream>
+using namespace std;
+int main(int argc, char* argv[])
+{
+    if (argc < 3)
+    {
+        cerr << "Usage: pack_builder <assets directory> <pack file>" << endl;
+        return 1;
+    }
+    if (!writePack(argv[1], argv[2]))
+    {
+        return 1;
+    }
+    AssetPack pack; // read it back, so a bad pack fails the build rather than the game
+    if (!openPack(pack, argv[2]))
+    {
+        return 1;
+    }
+    cout << "Packed " << pack.entries.size() << " files into " << argv[2] << " (" << pack.file.size << " bytes)" << endl;
+    closePack(pack);
+    return 0;
+}
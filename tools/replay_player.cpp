@@ -0,0 +1,122 @@
+// Headless replay playback: runs a recording as fast as the CPU allows, with no window or audio
+// Usage: replay_player <replay file> [threads] [--seek TICK] [--keyframes INTERVAL OUT_FILE] [--events]
+//   --seek TICK: jump to TICK through the nearest keyframe and play on from there
+//   --keyframes INTERVAL OUT_FILE: write a copy with a keyframe every INTERVAL ticks (0 = none)
+//   --events: print every tick's collision queue size and the events step() resolved it into
+#include "simulation.h"
+#include "replay.h"
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+using namespace std;
+const char eventNames[EVENT_COUNT][16] = {"shot", "kill", "player hit", "shield pickup", "level up",
+                                          "game over", "victory", "explosion", "bullet hit"};
+int main(int argc, char* argv[])
+{
+    if (argc < 2)
+    {
+        cerr << "Usage: replay_player <replay file> [threads] [--seek TICK] [--keyframes INTERVAL OUT_FILE] [--events]"
+             << endl;
+        return 1;
+    }
+    Replay replay;
+    if (!loadReplay(replay, argv[1]))
+    {
+        return 1;
+    }
+    long long seekTick = 0;
+    int keyframeInterval = -1; // -1 = keep the file as it is
+    const char* outPath = nullptr;
+    bool printEvents = false;
+    for (int i = 2; i < argc; i++)
+    {
+        if (strcmp(argv[i], "--seek") == 0 && i + 1 < argc)
+        {
+            seekTick = atoll(argv[++i]);
+        }
+        else if (strcmp(argv[i], "--keyframes") == 0 && i + 2 < argc)
+        {
+            keyframeInterval = atoi(argv[++i]);
+            outPath = argv[++i];
+        }
+        else if (strcmp(argv[i], "--events") == 0)
+        {
+            printEvents = true;
+        }
+        else
+        {
+            int threads = atoi(argv[i]);
+            if (threads < 1 || threads > MAX_BANDS)
+            {
+                cerr << "threads must be 1 to " << MAX_BANDS << endl;
+                return 1;
+            }
+            setSimulationThreads(threads);
+        }
+    }
+    GameState game;
+    setupBoard(game, replay.rows, replay.cols);
+    if (keyframeInterval >= 0)
+    {
+        if (!rebuildKeyframes(replay, game, keyframeInterval) || !saveReplay(replay, outPath))
+        {
+            return 1;
+        }
+        cout << "wrote " << outPath << " with " << replay.keyframes.size() << " keyframes" << endl;
+    }
+    long long tickCount = static_cast<long long>(replay.ticks.size());
+    auto seekStart = chrono::steady_clock::now();
+    if (!seekReplay(replay, game, seekTick))
+    {
+        cerr << "Cannot seek to tick " << seekTick << " (recording has " << tickCount << " ticks)" << endl;
+        return 1;
+    }
+    double seekSeconds = chrono::duration<double>(chrono::steady_clock::now() - seekStart).count();
+    long long eventCounts[EVENT_COUNT] = {0};
+    auto start = chrono::steady_clock::now();
+    for (long long tick = seekTick; tick < tickCount; tick++)
+    {
+        const vector<GameEvent>& events = playTick(replay, game, tick);
+        if (printEvents && !events.empty())
+        {
+            cout << "tick " << tick << ": " << game.collisions.size() << " collisions ->";
+            for (size_t i = 0; i < events.size(); i++)
+            {
+                cout << " " << eventNames[events[i].type] << " (" << events[i].row << "," << events[i].col << ")";
+                if (events[i].type == EVENT_KILL || events[i].type == EVENT_LEVEL_UP)
+                {
+                    cout << " " << events[i].value;
+                }
+            }
+            cout << endl;
+        }
+        for (size_t i = 0; i < events.size(); i++)
+        {
+            eventCounts[events[i].type]++;
+            if (events[i].type == EVENT_LEVEL_UP) // handy --seek targets
+            {
+                cout << "level " << events[i].value << " at tick " << tick + 1 << endl;
+            }
+        }
+    }
+    double seconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+    long long played = tickCount - seekTick;
+    cout << "board:        " << replay.rows << "x" << replay.cols << ", seed " << replay.seed << endl;
+    cout << "keyframes:    " << replay.keyframes.size() << " (every " << replay.keyframeInterval << " ticks)" << endl;
+    if (seekTick > 0)
+    {
+        cout << "seek:         tick " << seekTick << " in " << seekSeconds * 1000.0 << " ms" << endl;
+    }
+    cout << "ticks:        " << played << " (" << played / TICK_RATE << " s of game time)" << endl;
+    cout << "kills:        " << eventCounts[EVENT_KILL] << endl;
+    cout << "player hits:  " << eventCounts[EVENT_PLAYER_HIT] << endl;
+    cout << "final:        level " << game.level << ", score " << game.score << ", lives " << game.lives << endl;
+    cout << "checksum:     " << hex << stateChecksum(game) << dec << endl;
+    cout << "elapsed:      " << seconds << " s" << endl;
+    if (seconds > 0.0)
+    {
+        cout << "ticks/sec:    " << (long long)(played / seconds) << endl;
+    }
+    return 0;
+}
@@ -0,0 +1,101 @@
+#include "voices.h"
+using namespace sf;
+// Who wins a voice when they are all busy: losing a life or the game is never cut off by gunfire
+const int SOUND_PRIORITY[SOUND_COUNT] = {1, 2, 4, 3, 2, 2, 5, 5};
+const int MAX_SOUND_PRIORITY = 5;
+void setupVoices(VoicePool& pool, const SoundBuffer buffers[])
+{
+    for (int v = 0; v < VOICE_COUNT; v++)
+    {
+        pool.voices[v].effect = -1;
+        pool.voices[v].priority = 0;
+        pool.voices[v].startTime = 0.0f;
+    }
+    for (int e = 0; e < SOUND_COUNT; e++)
+    {
+        pool.buffers[e] = &buffers[e];
+        pool.pending[e] = false;
+        pool.lastStart[e] = -SOUND_MERGE_WINDOW;
+    }
+    pool.stats = VoiceStats();
+    pool.clock.restart();
+}
+void playSound(VoicePool& pool, int effect)
+{
+    pool.stats.requests++;
+    if (pool.pending[effect])
+    {
+        pool.stats.merged++;
+    }
+    pool.pending[effect] = true;
+}
+// A free voice if there is one, otherwise the least important one playing, as long as it matters no more
+// than the new sound (-1 = drop the new sound)
+int pickVoice(const VoicePool& pool, int priority, bool& steal)
+{
+    int best = -1;
+    for (int v = 0; v < VOICE_COUNT; v++)
+    {
+        const Voice& voice = pool.voices[v];
+        if (voice.effect < 0 || voice.sound.getStatus() == SoundSource::Stopped)
+        {
+            steal = false;
+            return v;
+        }
+        if (voice.priority <= priority &&
+            (best < 0 || voice.priority < pool.voices[best].priority ||
+             (voice.priority == pool.voices[best].priority && voice.startTime < pool.voices[best].startTime)))
+        {
+            best = v;
+        }
+    }
+    steal = true;
+    return best;
+}
+void flushSounds(VoicePool& pool)
+{
+    float now = pool.clock.getElapsedTime().asSeconds();
+    // Most important first, so a full pool gives its voices to the sounds that matter
+    for (int priority = MAX_SOUND_PRIORITY; priority >= 1; priority--)
+    {
+        for (int e = 0; e < SOUND_COUNT; e++)
+        {
+            if (!pool.pending[e] || SOUND_PRIORITY[e] != priority)
+            {
+                continue;
+            }
+            pool.pending[e] = false;
+            if (now - pool.lastStart[e] < SOUND_MERGE_WINDOW)
+            {
+                pool.stats.merged++;
+                continue;
+            }
+            bool steal;
+            int v = pickVoice(pool, priority, steal);
+            if (v < 0)
+            {
+                pool.stats.dropped++;
+                continue;
+            }
+            Voice& voice = pool.voices[v];
+            if (steal)
+            {
+                voice.sound.stop();
+                pool.stats.stolen++;
+            }
+            else
+            {
+                pool.stats.played++;
+            }
+            if (voice.effect != e)
+            {
+                voice.sound.setBuffer(*pool.buffers[e]);
+            }
+            voice.effect = e;
+            voice.priority = priority;
+            voice.startTime = now;
+            voice.sound.play();
+            pool.lastStart[e] = now;
+        }
+    }
+}
@@ -0,0 +1,49 @@
+// Sound effect voices
+// Every effect used to own one sf::Sound, so five kills in one tick just restarted the same explosion five
+// times and nothing stopped a busy board from asking for more than the mixer could play. Effects now play
+// through a fixed set of voices made once at startup (one OpenAL source each, the music has its own).
+// Requests are collected until the next flush (once per frame, after that frame's ticks), one per effect
+// however many came in, and an effect that started less than SOUND_MERGE_WINDOW ago is not started again.
+// When every voice is busy, the lowest priority voice is stolen (the oldest one on a tie), or the request is
+// dropped if everything playing matters more.
+#pragma once
+#include <SFML/Audio.hpp>
+// Effects, in the order their files are loaded
+const int SOUND_SHOOT = 0;
+const int SOUND_EXPLOSION = 1;
+const int SOUND_DAMAGE = 2;
+const int SOUND_LEVEL_UP = 3;
+const int SOUND_MENU_CLICK = 4;
+const int SOUND_MENU_NAV = 5;
+const int SOUND_WIN = 6;
+const int SOUND_LOSE = 7;
+const int SOUND_COUNT = 8;
+const int VOICE_COUNT = 12;              // sources budgeted for effects
+const float SOUND_MERGE_WINDOW = 0.04f;  // seconds; the same effect again this soon is heard as one
+struct Voice
+{
+    sf::Sound sound;
+    int effect;      // -1 = never used
+    int priority;
+    float startTime;
+};
+struct VoiceStats
+{
+    int requests; // playSound calls
+    int merged;   // same effect twice before a flush, or again inside the merge window
+    int played;   // started on a free voice
+    int stolen;   // started by cutting off a less important voice
+    int dropped;  // no voice could be given up for it
+};
+struct VoicePool
+{
+    Voice voices[VOICE_COUNT];
+    const sf::SoundBuffer* buffers[SOUND_COUNT];
+    bool pending[SOUND_COUNT]; // asked for since the last flush
+    float lastStart[SOUND_COUNT];
+    sf::Clock clock;
+    VoiceStats stats;
+};
+void setupVoices(VoicePool& pool, const sf::SoundBuffer buffers[]); // SOUND_COUNT buffers, in effect order
+void playSound(VoicePool& pool, int effect);
+void flushSounds(VoicePool& pool); // start what was asked for since the last flush